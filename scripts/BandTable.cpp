@@ -0,0 +1,217 @@
+#include "BandTable.h"
+#include "Solver.h"
+#include "Random.h"
+#include "Symmetry.h"
+
+#include <algorithm>
+#include <numeric>
+
+static constexpr std::array<std::array<uint8_t, 3>, 6> perms3 = { {
+	{ 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 }
+} };
+
+const BandTable& BandTable::instance() {
+	static const BandTable table(8);
+	return table;
+}
+
+BandTable::Band BandTable::normalize(Band band) {// Box 1 relabeled to 1..9, box 2/3 columns sorted by their top cell, then box 2 before box 3
+	std::array<uint8_t, 10> map{};
+
+	for (size_t r = 0; r < 3; r++) {
+		for (size_t c = 0; c < 3; c++) map[band[9 * r + c]] = uint8_t(3 * r + c + 1);
+	}
+
+	for (auto& cell : band) cell = map[cell];
+
+	auto swapCols = [&](size_t c1, size_t c2) {
+		for (size_t r = 0; r < 3; r++) std::swap(band[9 * r + c1], band[9 * r + c2]);
+	};
+
+	for (size_t s = 1; s < 3; s++) {
+		size_t base = 3 * s;
+		if (band[base] > band[base + 1]) swapCols(base, base + 1);
+		if (band[base + 1] > band[base + 2]) swapCols(base + 1, base + 2);
+		if (band[base] > band[base + 1]) swapCols(base, base + 1);
+	}
+
+	if (band[6] < band[3]) {
+		for (size_t c = 3; c < 6; c++) swapCols(c, c + 3);
+	}
+
+	return band;
+}
+
+std::vector<BandTable::Band> BandTable::normalizedBands() {// Every band already in normalize() form, in sorted order
+	std::vector<Band> out;
+
+	auto avoids = [](const uint8_t* part, uint16_t used) {
+		return !((used >> part[0]) & 1) && !((used >> part[1]) & 1) && !((used >> part[2]) & 1);
+	};
+
+	auto bits = [](const uint8_t* part) { return uint16_t((1u << part[0]) | (1u << part[1]) | (1u << part[2])); };
+
+	// Box 2's top row holds 4 plus two of 5..9, box 3's top row the other three, both ascending
+	for (uint8_t a = 5; a <= 9; a++) {
+		for (uint8_t b = a + 1; b <= 9; b++) {
+			Band band = { 1, 2, 3, 4, a, b, 0, 0, 0,
+			              4, 5, 6, 0, 0, 0, 0, 0, 0,
+			              7, 8, 9, 0, 0, 0, 0, 0, 0 };
+
+			for (uint8_t d = 5, i = 6; d <= 9; d++) {
+				if (d != a && d != b) band[i++] = d;
+			}
+
+			uint16_t top2 = bits(&band[3]), top3 = bits(&band[6]);
+			std::array<uint8_t, 6> mid = { 1, 2, 3, 7, 8, 9 };
+
+			do {
+				if (!avoids(&mid[0], top2) || !avoids(&mid[3], top3)) continue;
+
+				std::array<uint8_t, 6> low = { 1, 2, 3, 4, 5, 6 };
+				uint16_t used2 = top2 | bits(&mid[0]), used3 = top3 | bits(&mid[3]);
+
+				do {
+					if (!avoids(&low[0], used2) || !avoids(&low[3], used3)) continue;
+
+					std::copy(mid.begin(), mid.end(), band.begin() + 12);
+					std::copy(low.begin(), low.end(), band.begin() + 21);
+					out.push_back(band);
+				} while (std::next_permutation(low.begin(), low.end()));
+			} while (std::next_permutation(mid.begin(), mid.end()));
+		}
+	}
+
+	std::sort(out.begin(), out.end());
+	return out;
+}
+
+BandTable::Band BandTable::minlexBand(const Band& band) {
+	Band best;
+	bool first = true;
+
+	for (size_t top = 0; top < 3; top++) {
+		size_t o1 = (top + 1) % 3, o2 = (top + 2) % 3;
+
+		for (const auto& sp : perms3) {
+			for (const auto& p0 : perms3) {
+				for (const auto& p1 : perms3) {
+					for (const auto& p2 : perms3) {
+						const std::array<uint8_t, 3>* inner[3] = { &p0, &p1, &p2 };
+						std::array<uint8_t, 9> order;
+						std::array<uint8_t, 10> map{};
+
+						for (size_t j = 0; j < 9; j++) {
+							order[j] = uint8_t(3 * sp[j / 3] + (*inner[j / 3])[j % 3]);
+							map[band[9 * top + order[j]]] = uint8_t(j + 1);
+						}
+
+						Band cand;
+						for (size_t j = 0; j < 9; j++) {
+							cand[j] = uint8_t(j + 1);
+							cand[9 + j] = map[band[9 * o1 + order[j]]];
+							cand[18 + j] = map[band[9 * o2 + order[j]]];
+						}
+
+						// The two lower rows can go in either order, so the smaller one leads
+						if (std::lexicographical_compare(cand.begin() + 18, cand.end(), cand.begin() + 9, cand.begin() + 18)) {
+							std::swap_ranges(cand.begin() + 9, cand.begin() + 18, cand.begin() + 18);
+						}
+
+						if (first || cand < best) { best = cand; first = false; }
+					}
+				}
+			}
+		}
+	}
+
+	return best;
+}
+
+uint64_t BandTable::reference(size_t seed, const Symmetry& sym) {
+	return (uint64_t(seed) << Symmetry::codeBits) | sym.encode();
+}
+
+uint64_t BandTable::references() const {// Not dense: codes stop short of 2^41, so valid references have gaps
+	return uint64_t(grids.size()) << Symmetry::codeBits;
+}
+
+size_t BandTable::classOf(const Band& band) const {
+	Band key = normalize(band);
+	return familyClass[size_t(std::lower_bound(family.begin(), family.end(), key) - family.begin())];
+}
+
+BandTable::BandTable(size_t continuations) : per(continuations) {
+	/* --- Band classes: connect normalized bands that one row, column or stack swap apart --- */
+	family = normalizedBands();
+	std::vector<size_t> parent(family.size());
+	std::iota(parent.begin(), parent.end(), 0);
+
+	auto root = [&](size_t i) {
+		while (parent[i] != i) i = parent[i] = parent[parent[i]];
+		return i;
+	};
+
+	for (size_t i = 0; i < family.size(); i++) {
+		const Band& band = family[i];
+
+		auto link = [&](const Band& moved) {
+			Band key = normalize(moved);
+			size_t j = size_t(std::lower_bound(family.begin(), family.end(), key) - family.begin());
+			parent[root(j)] = root(i);
+		};
+
+		for (size_t a = 0; a < 3; a++) {
+			for (size_t b = a + 1; b < 3; b++) {
+				Band moved = band; // row swap
+				std::swap_ranges(moved.begin() + 9 * a, moved.begin() + 9 * a + 9, moved.begin() + 9 * b);
+				link(moved);
+
+				moved = band; // stack swap
+				for (size_t r = 0; r < 3; r++) std::swap_ranges(moved.begin() + 9 * r + 3 * a, moved.begin() + 9 * r + 3 * a + 3, moved.begin() + 9 * r + 3 * b);
+				link(moved);
+
+				for (size_t s = 0; s < 3; s++) { // column swap inside one stack
+					moved = band;
+					for (size_t r = 0; r < 3; r++) std::swap(moved[9 * r + 3 * s + a], moved[9 * r + 3 * s + b]);
+					link(moved);
+				}
+			}
+		}
+	}
+
+	for (size_t i = 0; i < family.size(); i++) {
+		if (root(i) == i) classes.push_back(minlexBand(family[i]));
+	}
+
+	std::sort(classes.begin(), classes.end());
+
+	familyClass.resize(family.size());
+	for (size_t i = 0; i < family.size(); i++) {
+		if (root(i) != i) continue;
+		Band key = minlexBand(family[i]);
+		familyClass[i] = uint16_t(std::lower_bound(classes.begin(), classes.end(), key) - classes.begin());
+	}
+
+	for (size_t i = 0; i < family.size(); i++) familyClass[i] = familyClass[root(i)];
+
+	/* --- Continuations: complete each class band into full grids --- */
+	// Fixed streams keep the table identical across runs, so seeded generation replays exactly
+	Solver solver;
+	Philox& rng = threadRng();
+	const Philox saved = rng;
+	grids.reserve(classes.size() * per);
+
+	for (size_t c = 0; c < classes.size(); c++) {
+		rng.reseed(0x5EEDBA4Dull, c);
+
+		for (size_t k = 0; k < per; k++) {
+			Cells cells{};
+			std::copy(classes[c].begin(), classes[c].end(), cells.begin());
+			solver.complete(cells); // Every band extends to a full grid, so this can't fail
+			grids.push_back(cells);
+		}
+	}
+
+	rng = saved;
+}
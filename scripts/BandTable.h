@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Symmetry;
+
+// Table of the 416 essentially different bands (minlex form, unique up to relabeling, row, column and stack
+// permutations), each stored with a few complete grids that continue it. A grid is produced by sampling a
+// stored continuation and applying a random symmetry, so generation never retries.
+class BandTable {
+
+public:
+
+  using Band = std::array<uint8_t, 27>;
+  using Cells = std::array<uint8_t, 81>;
+
+  // Shared table, built on first use
+  static const BandTable& instance();
+
+  explicit BandTable(size_t continuations);
+
+  const std::vector<Band>& bands() const { return classes; }
+  const std::vector<Cells>& seeds() const { return grids; }
+
+  // Corpus references pack a seed index above a symmetry code, so one 64-bit word stores a whole grid
+  static uint64_t reference(size_t seed, const Symmetry& sym);
+  uint64_t references() const;
+
+  // Index into bands() of the class a band belongs to; classes are sorted, so indexes order like minlex forms
+  size_t classOf(const Band& band) const;
+
+  // Lexicographically smallest band reachable by row, column and stack permutations plus relabeling
+  static Band minlexBand(const Band& band);
+
+private:
+
+  std::vector<Band> classes;
+  std::vector<Cells> grids; // continuations of classes[i] occupy [i * per, (i + 1) * per)
+  size_t per = 0;
+  std::vector<Band> family;          // every normalized band, sorted
+  std::vector<uint16_t> familyClass; // class index of family[i]
+
+  static std::vector<Band> normalizedBands();
+  static Band normalize(Band band);
+};
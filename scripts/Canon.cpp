@@ -0,0 +1,193 @@
+#include "Canon.h"
+
+#include <algorithm>
+
+static constexpr std::array<std::array<uint8_t, 3>, 6> perms3 = { {
+	{ 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 }
+} };
+
+static const std::array<std::array<uint8_t, 9>, 1296>& columnOrders() {// Stack order times the order inside each stack
+	static const auto orders = [] {
+		std::array<std::array<uint8_t, 9>, 1296> out{};
+		size_t n = 0;
+
+		for (const auto& sp : perms3) {
+			for (const auto& p0 : perms3) {
+				for (const auto& p1 : perms3) {
+					for (const auto& p2 : perms3) {
+						const std::array<uint8_t, 3>* inner[3] = { &p0, &p1, &p2 };
+						for (size_t j = 0; j < 9; j++) out[n][j] = uint8_t(3 * sp[j / 3] + (*inner[j / 3])[j % 3]);
+						n++;
+					}
+				}
+			}
+		}
+
+		return out;
+	}();
+
+	return orders;
+}
+
+static constexpr uint64_t topRow = 0x123456789ull;
+
+bool Canon::walk(const Cells& cells, Rows& best, bool stopEarly) {
+	const auto& orders = columnOrders();
+	Cells flipped;
+
+	for (size_t r = 0; r < 9; r++) {
+		for (size_t c = 0; c < 9; c++) flipped[9 * c + r] = cells[9 * r + c];
+	}
+
+	const Cells* sources[2] = { &cells, &flipped };
+
+	for (const Cells* g : sources) {
+		for (size_t top = 0; top < 9; top++) {
+			size_t band = top / 3;
+			size_t m1 = 3 * band + (top + 1) % 3, m2 = 3 * band + (top + 2) % 3;
+
+			for (const auto& order : orders) {
+				std::array<uint8_t, 10> map{};
+				for (size_t j = 0; j < 9; j++) map[(*g)[9 * top + order[j]]] = uint8_t(j + 1);
+
+				auto pack = [&](size_t r) {
+					uint64_t key = 0;
+					for (size_t j = 0; j < 9; j++) key = (key << 4) | map[(*g)[9 * r + order[j]]];
+					return key;
+				};
+
+				// Relabeling forces the top row to 1..9, so the comparison starts at the band mates
+				Rows cand;
+				cand[0] = topRow;
+				cand[1] = pack(m1); cand[2] = pack(m2);
+				if (cand[2] < cand[1]) std::swap(cand[1], cand[2]);
+
+				bool less = cand[0] < best[0];
+				if (!less && cand[0] == best[0]) {
+					if (cand[1] > best[1]) continue;
+					less = cand[1] < best[1];
+					if (!less) {
+						if (cand[2] > best[2]) continue;
+						less = cand[2] < best[2];
+					}
+				}
+
+				// Lower bands: rows sorted inside each band, bands ordered by their leading row
+				std::array<uint64_t, 3> lower[2];
+				for (size_t b = 0, k = 0; b < 3; b++) {
+					if (b == band) continue;
+					for (size_t i = 0; i < 3; i++) lower[k][i] = pack(3 * b + i);
+					std::sort(lower[k].begin(), lower[k].end());
+					k++;
+				}
+
+				if (lower[1][0] < lower[0][0]) std::swap(lower[0], lower[1]);
+				std::copy(lower[0].begin(), lower[0].end(), cand.begin() + 3);
+				std::copy(lower[1].begin(), lower[1].end(), cand.begin() + 6);
+
+				if (!less) {
+					if (!(cand < best)) continue;
+				}
+
+				if (stopEarly) return false;
+				best = cand;
+			}
+		}
+	}
+
+	return true;
+}
+
+Canon::Cells Canon::minlex(const Cells& cells) {
+	Rows best;
+	best.fill(~uint64_t(0));
+	walk(cells, best, false);
+
+	Cells out;
+	for (size_t r = 0; r < 9; r++) {
+		for (size_t c = 0; c < 9; c++) out[9 * r + c] = uint8_t((best[r] >> (4 * (8 - c))) & 0xF);
+	}
+
+	return out;
+}
+
+bool Canon::isMinlex(const Cells& cells) {
+	Rows self;
+	for (size_t r = 0; r < 9; r++) {
+		uint64_t key = 0;
+		for (size_t c = 0; c < 9; c++) key = (key << 4) | cells[9 * r + c];
+		self[r] = key;
+	}
+
+	if (self[0] != topRow) return false;
+	return walk(cells, self, true);
+}
+
+std::vector<Symmetry> Canon::automorphisms(const Cells& cells) {// Placing the image's first box fixes the relabeling, and every other line then follows from one digit
+	Cells flipped;
+	for (size_t r = 0; r < 9; r++) {
+		for (size_t c = 0; c < 9; c++) flipped[9 * c + r] = cells[9 * r + c];
+	}
+
+	const Cells* sources[2] = { &cells, &flipped };
+	std::vector<Symmetry> out;
+
+	for (size_t t = 0; t < 2; t++) {
+		const Cells& g = *sources[t];
+
+		// Column of each digit in a row, row of each digit in a column
+		std::array<std::array<uint8_t, 10>, 9> colOf, rowOf;
+		for (size_t r = 0; r < 9; r++) {
+			for (size_t c = 0; c < 9; c++) { colOf[r][g[9 * r + c]] = uint8_t(c); rowOf[c][g[9 * r + c]] = uint8_t(r); }
+		}
+
+		for (size_t top = 0; top < 9; top++) {
+			size_t band = top / 3;
+			size_t mates[2] = { 3 * band + (top + 1) % 3, 3 * band + (top + 2) % 3 };
+
+			for (size_t stack = 0; stack < 3; stack++) {
+				for (const auto& inner : perms3) {
+					for (size_t m = 0; m < 2; m++) {
+						Symmetry sym;
+						sym.transpose = t;
+						sym.rows[0] = uint8_t(top);
+						sym.rows[1] = uint8_t(mates[m]);
+						sym.rows[2] = uint8_t(mates[1 - m]);
+						for (size_t j = 0; j < 3; j++) sym.cols[j] = uint8_t(3 * stack + inner[j]);
+
+						// The first box holds every digit once, so matching it to the grid's first box is a full relabeling
+						std::array<uint8_t, 10> from{};
+						for (size_t r = 0; r < 3; r++) {
+							for (size_t j = 0; j < 3; j++) {
+								uint8_t d = g[9 * sym.rows[r] + sym.cols[j]];
+								sym.digits[d] = cells[9 * r + j];
+								from[cells[9 * r + j]] = d;
+							}
+						}
+
+						// The rest of the top row places the columns, the rest of the first column the rows
+						bool lines = true;
+						for (size_t i = 3; i < 9; i++) {
+							sym.cols[i] = colOf[top][from[cells[i]]];
+							sym.rows[i] = rowOf[sym.cols[0]][from[cells[9 * i]]];
+						}
+						for (size_t b = 3; b < 9 && lines; b += 3) {
+							lines = sym.cols[b] / 3 == sym.cols[b + 1] / 3 && sym.cols[b] / 3 == sym.cols[b + 2] / 3 &&
+							        sym.rows[b] / 3 == sym.rows[b + 1] / 3 && sym.rows[b] / 3 == sym.rows[b + 2] / 3;
+						}
+						if (!lines) continue;
+
+						bool fixed = true;
+						for (size_t r = 0; r < 9 && fixed; r++) {
+							for (size_t c = 0; c < 9 && fixed; c++) fixed = sym.digits[g[9 * sym.rows[r] + sym.cols[c]]] == cells[9 * r + c];
+						}
+
+						if (fixed) out.push_back(sym);
+					}
+				}
+			}
+		}
+	}
+
+	return out;
+}
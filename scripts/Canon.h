@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Symmetry.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Canonical (minlex) form of a full grid under the whole validity-preserving group: band and stack permutations,
+// row and column permutations inside them, transposition and relabeling. Two grids are essentially the same
+// exactly when their minlex forms match.
+class Canon {
+
+public:
+
+  using Cells = std::array<uint8_t, 81>;
+
+  static Cells minlex(const Cells& cells);
+
+  // True when no symmetry maps the grid to something smaller, i.e. it is already its own minlex form
+  static bool isMinlex(const Cells& cells);
+
+  // Every symmetry that maps the full grid onto itself, the identity first. The grid has exactly
+  // Symmetry::codes / automorphisms(cells).size() distinct images; nearly every grid has the identity alone.
+  static std::vector<Symmetry> automorphisms(const Cells& cells);
+
+private:
+
+  using Rows = std::array<uint64_t, 9>; // one nibble per cell, first cell most significant
+
+  // Walks every top row, transpose and column order; with stopEarly it returns false on the first variant below best
+  static bool walk(const Cells& cells, Rows& best, bool stopEarly);
+};
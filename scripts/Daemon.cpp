@@ -0,0 +1,230 @@
+#include "Daemon.h"
+#include "Sudoku.h"
+#include "Solver.h"
+
+#include <algorithm>
+#include <sstream>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <unistd.h>
+	#define DAEMON_SOCKETS 1
+	#include <cerrno>
+
+	#ifndef MSG_NOSIGNAL
+		#define MSG_NOSIGNAL 0 // BSD/macOS: SO_NOSIGPIPE on each client socket does the same
+	#endif
+#endif
+
+Daemon::Daemon(const Options& opts) : options(opts), queue(opts.capacity) {
+	if (!options.high || options.high > queue.capacity()) options.high = queue.capacity();
+	if (!options.low || options.low > options.high) options.low = options.high / 2;
+	if (!options.threads) options.threads = 1;
+
+	if (options.band) Sudoku().band_generate(); // Build the band table once, before any request
+
+	for (size_t t = 0; t < options.threads; t++) workers.emplace_back(&Daemon::fill, this);
+}
+
+Daemon::~Daemon() {
+	stop();
+	for (auto& t : workers) t.join();
+
+	std::vector<std::thread> done;
+	{
+		std::lock_guard<std::mutex> lock(clientLock);
+		done.swap(clients);
+	}
+	for (auto& t : done) t.join();
+}
+
+Daemon::Cells Daemon::make() {
+	thread_local Sudoku s;
+	thread_local Solver solver;
+	size_t pos = 0;
+
+	do {
+		if (options.band) s.band_generate();
+		else { s.root_generate(true, s.getBox(pos), 8 - pos); pos = (pos + 1) % 9; }
+	} while (!s.validateGrid());
+
+	generated++;
+	return options.puzzles ? solver.minimize(s.getCells()) : s.getCells();
+}
+
+void Daemon::fill() {// Top the queue up to the high watermark, then sleep until a take drops it below the low one
+	while (running) {
+		while (running && queue.size() < options.high) {
+			if (!queue.push(make())) break;
+		}
+
+		std::unique_lock<std::mutex> lock(idle);
+		refill.wait(lock, [&] { return !running || queue.size() < options.low; });
+		wakeups++;
+	}
+}
+
+Daemon::Cells Daemon::take() {
+	Cells cells;
+	served++;
+
+	if (!queue.pop(cells)) { misses++; cells = make(); }
+
+	// Only the crossing into the refill band pays for a notify
+	if (queue.size() < options.low) {
+		std::lock_guard<std::mutex> lock(idle);
+		refill.notify_all();
+	}
+
+	return cells;
+}
+
+Daemon::Metrics Daemon::metrics() const {
+	return { served.load(), misses.load(), generated.load(), wakeups.load(), queue.size(), queue.capacity() };
+}
+
+std::string Daemon::metricsLine() const {
+	Metrics m = metrics();
+	std::ostringstream oss;
+	oss << "served=" << m.served << " misses=" << m.misses << " generated=" << m.generated << " wakeups=" << m.wakeups
+	    << " depth=" << m.depth << " capacity=" << m.capacity << " low=" << options.low << " high=" << options.high;
+	return oss.str();
+}
+
+void Daemon::stop() {
+	running = false;
+	{
+		std::lock_guard<std::mutex> lock(idle);
+		refill.notify_all();
+	}
+
+#ifdef DAEMON_SOCKETS
+	interrupt();
+
+	std::lock_guard<std::mutex> lock(clientLock);
+	for (int fd : clientFds) shutdown(fd, SHUT_RDWR);
+#endif
+}
+
+void Daemon::interrupt() {
+	running = false;
+
+#ifdef DAEMON_SOCKETS
+	int fd = listener.load();
+	if (fd >= 0) shutdown(fd, SHUT_RDWR);
+#endif
+}
+
+#ifdef DAEMON_SOCKETS
+
+void Daemon::client(int fd) {// Line protocol: "grid" (or an empty line) answers 81 digits, "stats" the metrics, "quit" closes
+	std::string pending, reply;
+	char buffer[4096];
+
+	for (ssize_t got; running && (got = read(fd, buffer, sizeof(buffer))) > 0;) {
+		pending.append(buffer, size_t(got));
+		reply.clear();
+
+		for (size_t nl; (nl = pending.find('\n')) != std::string::npos;) {
+			std::string line = pending.substr(0, nl);
+			pending.erase(0, nl + 1);
+			if (!line.empty() && line.back() == '\r') line.pop_back();
+
+			if (line.empty() || line == "grid") {
+				Cells cells = take();
+				for (uint8_t v : cells) reply.push_back(v ? char('0' + v) : '.');
+				reply.push_back('\n');
+			}
+			else if (line == "stats") reply += metricsLine() + '\n';
+			else if (line == "quit") { pending.clear(); got = 0; break; }
+			else reply += "error unknown request\n";
+		}
+
+		// A client that hung up (EPIPE, ECONNRESET) only ends its own connection: no SIGPIPE for the daemon
+		for (size_t sent = 0; sent < reply.size();) {
+			ssize_t n = send(fd, reply.data() + sent, reply.size() - sent, MSG_NOSIGNAL);
+			if (n < 0 && errno == EINTR) continue;
+			if (n <= 0) { got = 0; break; }
+			sent += size_t(n);
+		}
+
+		if (!got) break;
+	}
+
+	std::lock_guard<std::mutex> lock(clientLock);
+	clientFds.erase(std::find(clientFds.begin(), clientFds.end(), fd));
+	close(fd);
+	finished.push_back(std::this_thread::get_id());
+}
+
+void Daemon::reap() {// Joins clients that have finished, so a long run holds threads only for open connections
+	std::vector<std::thread> done;
+	{
+		std::lock_guard<std::mutex> lock(clientLock);
+		for (std::thread::id id : finished) {
+			auto it = std::find_if(clients.begin(), clients.end(), [id](const std::thread& t) { return t.get_id() == id; });
+			if (it == clients.end()) continue;
+			done.push_back(std::move(*it));
+			clients.erase(it);
+		}
+		finished.clear();
+	}
+	for (auto& t : done) t.join(); // each has at most its return left to run
+}
+
+bool Daemon::serve(const std::string& path) {
+	sockaddr_un addr{};
+	if (path.size() >= sizeof(addr.sun_path)) return false;
+
+	int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (sock < 0) return false;
+
+	addr.sun_family = AF_UNIX;
+	std::copy(path.begin(), path.end(), addr.sun_path);
+	unlink(path.c_str());
+
+	if (bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(sock, 64) < 0) {
+		close(sock);
+		return false;
+	}
+
+	listener = sock;
+
+	while (running) {
+		int fd = accept(sock, nullptr, nullptr);
+		if (fd < 0) { if (!running) break; continue; }
+
+		reap();
+
+#ifdef SO_NOSIGPIPE
+		int on = 1;
+		setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+
+		std::lock_guard<std::mutex> lock(clientLock);
+		clientFds.push_back(fd);
+		try {
+			clients.emplace_back(&Daemon::client, this, fd);
+		} catch (const std::system_error&) {// Out of threads: turn this connection away and keep serving
+			clientFds.pop_back();
+			close(fd);
+		}
+	}
+
+	listener = -1;
+	close(sock);
+	unlink(path.c_str());
+	return true;
+}
+
+#else
+
+void Daemon::client(int) {}
+
+void Daemon::reap() {}
+
+bool Daemon::serve(const std::string&) { return false; } // No Unix sockets here; take() still works in-process
+
+#endif
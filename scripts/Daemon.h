@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Queue.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Long-running generator service. Refill threads keep a lock-free queue of validated grids (or minimal puzzles)
+// between a low and a high watermark, so a request costs one dequeue; an empty queue falls back to generating
+// inline and is counted as a miss. Clients connect over a Unix domain socket.
+class Daemon {
+
+public:
+
+  using Cells = std::array<uint8_t, 81>;
+
+  struct Options {
+    size_t capacity = 65536;
+    size_t low = 0;      // refill wakes below this; 0 means half the capacity
+    size_t high = 0;     // and sleeps at this; 0 means the full capacity
+    size_t threads = 1;  // refill threads
+    bool band = true;    // band table engine, else root propagation
+    bool puzzles = false; // serve minimal puzzles instead of full grids
+  };
+
+  struct Metrics {
+    uint64_t served, misses, generated, wakeups;
+    size_t depth, capacity;
+  };
+
+  explicit Daemon(const Options& options);
+  ~Daemon();
+
+  Daemon(const Daemon&) = delete;
+  Daemon& operator=(const Daemon&) = delete;
+
+  // One grid or puzzle, from the queue when it has one
+  Cells take();
+
+  Metrics metrics() const;
+  std::string metricsLine() const;
+
+  // Blocks serving the socket at path until stop() or interrupt(); false when the socket can't be opened
+  bool serve(const std::string& path);
+  void stop();
+
+  // Async-signal-safe: flags shutdown and unblocks serve(), which returns so the owner can destroy the daemon
+  void interrupt();
+
+private:
+
+  Options options;
+  BoundedQueue<Cells> queue;
+
+  std::atomic<bool> running{ true };
+  std::atomic<uint64_t> served{ 0 }, misses{ 0 }, generated{ 0 }, wakeups{ 0 };
+
+  std::mutex idle;
+  std::condition_variable refill;
+  std::vector<std::thread> workers;
+
+  std::atomic<int> listener{ -1 };
+  std::mutex clientLock;
+  std::vector<std::thread> clients;
+  std::vector<int> clientFds; // open connections, shut down by stop()
+  std::vector<std::thread::id> finished; // clients that returned and await a join
+
+  void reap();
+
+  Cells make();
+  void fill();
+  void client(int fd);
+};
@@ -0,0 +1,234 @@
+#include "Enumerator.h"
+#include "BandTable.h"
+#include "Canon.h"
+#include "Format.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+	#include <unistd.h>
+	#define ENUMERATOR_FSYNC 1
+#endif
+
+namespace {
+
+// Flushes, syncs and closes a finished unit; false if any of it failed, so a unit is never renamed half-written
+bool commit(std::FILE* out) {
+	bool ok = std::fflush(out) == 0 && !std::ferror(out);
+#ifdef ENUMERATOR_FSYNC
+	ok = ok && fsync(fileno(out)) == 0;
+#endif
+	return (std::fclose(out) == 0) && ok;
+}
+
+// Fixed-order completion of rows 4..9 under one top band, keeping only grids in minlex form
+class UnitSearch {
+
+public:
+
+	UnitSearch(size_t cls, const std::array<uint8_t, 6>& column, const std::function<void(const Enumerator::Cells&)>& visit)
+		: table(BandTable::instance()), cls(cls), visit(visit) {
+		const BandTable::Band& band = table.bands()[cls];
+		std::copy(band.begin(), band.end(), grid.begin());
+		for (size_t pos = 0; pos < 27; pos++) place(pos, grid[pos]);
+		for (size_t r = 0; r < 6; r++) place(9 * (r + 3), column[r]);
+	}
+
+	size_t run() { fill(28); return found; }
+
+private:
+
+	const BandTable& table;
+	size_t cls;
+	const std::function<void(const Enumerator::Cells&)>& visit;
+	Enumerator::Cells grid{};
+	std::array<uint16_t, 9> rows{}, cols{}, boxes{};
+	size_t found = 0;
+
+	static constexpr size_t boxOf(size_t pos) { return 3 * (pos / 27) + (pos % 9) / 3; }
+
+	void place(size_t pos, uint8_t val) {
+		uint16_t bit = uint16_t(1u << val);
+		rows[pos / 9] |= bit; cols[pos % 9] |= bit; boxes[boxOf(pos)] |= bit;
+		grid[pos] = val;
+	}
+
+	void lift(size_t pos) {
+		uint16_t keep = uint16_t(~(1u << grid[pos]));
+		rows[pos / 9] &= keep; cols[pos % 9] &= keep; boxes[boxOf(pos)] &= keep;
+		grid[pos] = 0;
+	}
+
+	// A grid whose other bands or stacks canonicalize below the top band can't be in minlex form
+	bool bandAtLeastTop(size_t first) const {
+		BandTable::Band other;
+		std::copy(grid.begin() + 27 * first, grid.begin() + 27 * first + 27, other.begin());
+		return table.classOf(other) >= cls;
+	}
+
+	bool stackAtLeastTop(size_t stack) const {
+		BandTable::Band other;
+		for (size_t c = 0; c < 3; c++) {
+			for (size_t r = 0; r < 9; r++) other[9 * c + r] = grid[9 * r + 3 * stack + c];
+		}
+		return table.classOf(other) >= cls;
+	}
+
+	void fill(size_t pos) {
+		if (pos == 54 && !bandAtLeastTop(1)) return;
+
+		if (pos == 81) {
+			if (!bandAtLeastTop(2)) return;
+			for (size_t s = 0; s < 3; s++) {
+				if (!stackAtLeastTop(s)) return;
+			}
+
+			if (Canon::isMinlex(grid)) { visit(grid); found++; }
+			return;
+		}
+
+		if (pos % 9 == 0) { fill(pos + 1); return; } // first column is fixed by the unit
+
+		uint16_t open = uint16_t(~(rows[pos / 9] | cols[pos % 9] | boxes[boxOf(pos)]) & 0x3FE);
+
+		for (uint8_t d = 1; d <= 9; d++) {
+			if (!(open & (1u << d))) continue;
+			place(pos, d);
+			fill(pos + 1);
+			lift(pos);
+		}
+	}
+};
+
+} // namespace
+
+Enumerator::Enumerator(std::string dir, Shard shard, size_t threads) : dir(std::move(dir)), shard(shard), threads(threads) {
+	if (!this->shard.count || this->shard.index >= this->shard.count) throw std::invalid_argument("Enumerator: shard index out of range");
+	if (!this->threads) this->threads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+size_t Enumerator::units() { return BandTable::instance().bands().size() * splits; }
+
+size_t Enumerator::walkUnit(size_t unit, const std::function<void(const Cells&)>& visit) {
+	const auto& bands = BandTable::instance().bands();
+	if (unit >= bands.size() * splits) throw std::out_of_range("Enumerator: unit out of range");
+
+	size_t cls = unit / splits;
+	const BandTable::Band& band = bands[cls];
+
+	// In minlex form rows 4..9 are sorted inside their bands and band 2 leads band 3, so the smallest free digit
+	// of column 1 heads row 4 and the split only decides which two of the remaining five join it
+	uint16_t used = 0;
+	for (size_t r = 0; r < 3; r++) used |= uint16_t(1u << band[9 * r]);
+
+	std::array<uint8_t, 6> free{};
+	for (uint8_t d = 1, n = 0; d <= 9; d++) {
+		if (!(used & (1u << d))) free[n++] = d;
+	}
+
+	size_t split = unit % splits, k = 0;
+	for (size_t a = 1; a < 6; a++) {
+		for (size_t b = a + 1; b < 6; b++, k++) {
+			if (k != split) continue;
+
+			std::array<uint8_t, 6> column = { free[0], free[a], free[b] };
+			for (size_t i = 1, n = 3; i < 6; i++) {
+				if (i != a && i != b) column[n++] = free[i];
+			}
+
+			return UnitSearch(cls, column, visit).run();
+		}
+	}
+
+	return 0;
+}
+
+Enumerator::Packed Enumerator::pack(const Cells& cells) {
+	Packed out;
+	Format::binary(cells, reinterpret_cast<char*>(out.data()));
+	return out;
+}
+
+Enumerator::Cells Enumerator::unpack(const Packed& packed) {
+	Cells out;
+	for (size_t i = 0; i < 81; i++) out[i] = uint8_t((packed[i / 2] >> ((i & 1) ? 0 : 4)) & 0xF);
+	return out;
+}
+
+std::string Enumerator::unitPath(size_t unit) const {
+	char name[32];
+	std::snprintf(name, sizeof(name), "unit-%05zu.ed", unit);
+	return dir + "/" + name;
+}
+
+size_t Enumerator::run() {
+	std::filesystem::create_directories(dir);
+	const std::string checkpoint = dir + "/checkpoint";
+
+	/* --- Resume: every line of the checkpoint is a finished "unit count" pair --- */
+	std::set<size_t> finished;
+	{
+		std::ifstream in(checkpoint);
+		size_t unit, count;
+		while (in >> unit >> count) finished.insert(unit);
+	}
+
+	std::vector<size_t> pending;
+	for (size_t u = shard.index; u < units(); u += shard.count) {
+		if (!finished.count(u)) pending.push_back(u);
+	}
+
+	done = 0;
+	std::atomic<size_t> next{ 0 }, written{ 0 };
+	std::mutex logLock;
+	std::exception_ptr failure;
+
+	auto worker = [&]() {
+		try {
+			for (size_t i = next++; i < pending.size(); i = next++) {
+				size_t unit = pending[i];
+				std::string path = unitPath(unit), part = path + ".part";
+
+				std::FILE* out = std::fopen(part.c_str(), "wb");
+				if (!out) throw std::runtime_error("Enumerator: cannot open " + part);
+
+				size_t count = walkUnit(unit, [&](const Cells& cells) {
+					Packed packed = pack(cells);
+					std::fwrite(packed.data(), 1, packed.size(), out);
+				});
+
+				if (!commit(out) || std::rename(part.c_str(), path.c_str())) throw std::runtime_error("Enumerator: cannot write " + path);
+
+				written += count;
+
+				std::lock_guard<std::mutex> lock(logLock);
+				std::ofstream log(checkpoint, std::ios::app);
+				log << unit << ' ' << count << '\n';
+				if (!log.flush()) throw std::runtime_error("Enumerator: cannot update " + checkpoint);
+				done++;
+			}
+		} catch (...) {
+			std::lock_guard<std::mutex> lock(logLock);
+			if (!failure) failure = std::current_exception();
+			next = pending.size();
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (size_t t = 1; t < std::min(threads, pending.size()); t++) pool.emplace_back(worker);
+	worker();
+	for (auto& th : pool) th.join();
+
+	if (failure) std::rethrow_exception(failure);
+	return written;
+}
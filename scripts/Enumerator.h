@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Exhaustive walk over the essentially different grids. Work is cut into units, one per band class and split of
+// the lower first-column digits between bands 2 and 3, so units can be sharded across processes and threads.
+// Each finished unit lands in its own packed file and a line in the checkpoint, which is what a resumed run skips.
+class Enumerator {
+
+public:
+
+  using Cells = std::array<uint8_t, 81>;
+  using Packed = std::array<uint8_t, 41>; // two cells per byte, high nibble first
+
+  struct Shard {
+    size_t index = 0;
+    size_t count = 1;
+  };
+
+  static constexpr size_t splits = 10; // choose 2 of the 5 first-column digits left over for band 2
+
+  Enumerator(std::string dir, Shard shard, size_t threads = 0);
+
+  static size_t units();
+
+  // Every minlex grid in one unit, in search order; returns how many were visited
+  static size_t walkUnit(size_t unit, const std::function<void(const Cells&)>& visit);
+
+  // Runs this shard's unfinished units; returns the grids written by this run
+  size_t run();
+
+  size_t unitsDone() const { return done; }
+
+  static Packed pack(const Cells& cells);
+  static Cells unpack(const Packed& packed);
+
+private:
+
+  std::string dir;
+  Shard shard;
+  size_t threads;
+  size_t done = 0;
+
+  std::string unitPath(size_t unit) const;
+};
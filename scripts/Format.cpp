@@ -0,0 +1,130 @@
+#include "Format.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <unistd.h>
+
+static constexpr char lineDigits[10] = { '.', '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+static constexpr char prettyDigits[10] = { '#', '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+
+// "d d d | d d d | d d d \n" per row, a rule after bands 1 and 2, then the blank line printGrid ends with
+struct PrettyLayout {
+	std::array<char, 253> text{};
+	std::array<uint8_t, 81> at{};
+};
+
+static constexpr PrettyLayout prettyLayout = [] {
+	PrettyLayout layout{};
+	const char rule[] = "------+-------+------\n";
+	size_t n = 0;
+
+	for (size_t r = 0; r < 9; r++) {
+		for (size_t c = 0; c < 9; c++) {
+			layout.at[9 * r + c] = uint8_t(n);
+			layout.text[n++] = '#';
+			layout.text[n++] = ' ';
+			if (c == 2 || c == 5) { layout.text[n++] = '|'; layout.text[n++] = ' '; }
+		}
+		layout.text[n++] = '\n';
+
+		if (r == 2 || r == 5) {
+			for (size_t i = 0; rule[i]; i++) layout.text[n++] = rule[i];
+		}
+	}
+
+	layout.text[n++] = '\n';
+	layout.text[n++] = '\n';
+	return layout;
+}();
+
+size_t Format::line(const Cells& cells, char* out) {
+	for (size_t i = 0; i < 81; i++) out[i] = lineDigits[cells[i]];
+	out[81] = '\n';
+	return 82;
+}
+
+size_t Format::pretty(const Cells& cells, char* out) {
+	std::memcpy(out, prettyLayout.text.data(), prettyLayout.text.size());
+	for (size_t i = 0; i < 81; i++) out[prettyLayout.at[i]] = prettyDigits[cells[i]];
+	return prettyLayout.text.size();
+}
+
+size_t Format::csv(const Cells& cells, char* out) {
+	for (size_t i = 0; i < 81; i++) {
+		out[2 * i] = char('0' + cells[i]);
+		out[2 * i + 1] = ',';
+	}
+	out[161] = '\n';
+	return 162;
+}
+
+size_t Format::json(const Cells& cells, char* out) {
+	static constexpr char head[] = "{\"grid\":\"", tail[] = "\"}\n";
+	std::memcpy(out, head, sizeof(head) - 1);
+	size_t n = sizeof(head) - 1;
+
+	for (size_t i = 0; i < 81; i++) out[n + i] = lineDigits[cells[i]];
+	n += 81;
+
+	std::memcpy(out + n, tail, sizeof(tail) - 1);
+	return n + sizeof(tail) - 1;
+}
+
+size_t Format::binary(const Cells& cells, char* out) {
+	for (size_t i = 0; i < 40; i++) out[i] = char((cells[2 * i] << 4) | cells[2 * i + 1]);
+	out[40] = char(cells[80] << 4);
+	return 41;
+}
+
+size_t Format::write(Kind kind, const Cells& cells, char* out) {
+	switch (kind) {
+		case Kind::Line: return line(cells, out);
+		case Kind::Pretty: return pretty(cells, out);
+		case Kind::Csv: return csv(cells, out);
+		case Kind::Json: return json(cells, out);
+		case Kind::Binary: return binary(cells, out);
+	}
+	return 0;
+}
+
+bool Format::parse(const std::string& name, Kind& kind) {
+	if (name == "line") kind = Kind::Line;
+	else if (name == "pretty") kind = Kind::Pretty;
+	else if (name == "csv") kind = Kind::Csv;
+	else if (name == "json") kind = Kind::Json;
+	else if (name == "binary" || name == "packed") kind = Kind::Binary;
+	else return false;
+	return true;
+}
+
+BlockWriter::BlockWriter(int fd, size_t blockBytes) : fd(fd), block(blockBytes < Format::maxBytes ? Format::maxBytes : blockBytes) {}
+
+BlockWriter::~BlockWriter() { flush(); }
+
+void BlockWriter::grid(Format::Kind kind, const Format::Cells& cells) {
+	if (used + Format::maxBytes > block.size()) flush();
+	used += Format::write(kind, cells, block.data() + used);
+}
+
+void BlockWriter::text(const char* data, size_t length) {
+	while (length) {
+		if (used == block.size()) flush();
+
+		size_t take = std::min(length, block.size() - used);
+		std::memcpy(block.data() + used, data, take);
+		used += take; data += take; length -= take;
+	}
+}
+
+bool BlockWriter::flush() {
+	for (size_t sent = 0; sent < used && !failure;) {
+		ssize_t n = ::write(fd, block.data() + sent, used - sent);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) { failure = n < 0 ? errno : EIO; break; }
+		sent += size_t(n);
+	}
+	used = 0;
+	return !failure;
+}
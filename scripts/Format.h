@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Grid formatters that write into caller buffers. Digits come from a lookup table and the pretty layout is a
+// fixed template with the 81 cell offsets precomputed, so formatting a grid is a copy plus 81 stores.
+class Format {
+
+public:
+
+  using Cells = std::array<uint8_t, 81>;
+
+  enum class Kind { Line, Pretty, Csv, Json, Binary };
+
+  // Upper bound on the bytes any kind writes for one grid
+  static constexpr size_t maxBytes = 256;
+
+  static size_t line(const Cells& cells, char* out);   // 81 chars ('.' blanks) and '\n'
+  static size_t pretty(const Cells& cells, char* out); // printGrid's 9x9 layout ('#' blanks), blank line after
+  static size_t csv(const Cells& cells, char* out);    // 81 comma-separated digits ('0' blanks) and '\n'
+  static size_t json(const Cells& cells, char* out);   // {"grid":"<line>"} and '\n'
+  static size_t binary(const Cells& cells, char* out); // 41 bytes, two cells per byte, high nibble first
+
+  static size_t write(Kind kind, const Cells& cells, char* out);
+
+  // line/pretty/csv/json/binary (packed is an alias for binary); false for anything else
+  static bool parse(const std::string& name, Kind& kind);
+};
+
+// Buffered sink over a file descriptor: formatted grids and text pile up in one block that goes out in a single
+// write() when it fills, on flush(), or on destruction
+class BlockWriter {
+
+public:
+
+  explicit BlockWriter(int fd, size_t blockBytes = 1 << 20);
+  ~BlockWriter();
+
+  BlockWriter(const BlockWriter&) = delete;
+  BlockWriter& operator=(const BlockWriter&) = delete;
+
+  void grid(Format::Kind kind, const Format::Cells& cells);
+  void text(const char* data, size_t length);
+  void text(const std::string& s) { text(s.data(), s.size()); }
+
+  // False once any write() has failed; the first failure's errno stays in error() and later output is discarded
+  bool flush();
+  int error() const { return failure; }
+
+private:
+
+  int fd;
+  std::vector<char> block;
+  size_t used = 0;
+  int failure = 0;
+};
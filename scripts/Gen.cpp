@@ -1,4 +1,16 @@
 #include "Sudoku.h"
+#include "Enumerator.h"
+#include "Random.h"
+#include "Pattern.h"
+#include "Solver.h"
+#include "Daemon.h"
+#include "Writer.h"
+#include "Ingest.h"
+#include "Format.h"
+#include "Perf.h"
+#include "Stream.h"
+#include "Canon.h"
+#include "Placement.h"
 
 #ifndef Sudoku_H
   #error X0
@@ -10,11 +22,19 @@
 #define equiv(a, b) a == b
 
 #include <thread>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <chrono>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <fstream>
 #include <unordered_set>
+#include <csignal>
+#include <atomic>
+#include <fcntl.h>
+#include <unistd.h>
 
 static std::string as_percent(double value, int decimals = 1) {
   std::ostringstream oss;
@@ -46,12 +66,52 @@ static bool isTransform(const std::string& m) {
   return aliases.find(m) != aliases.end();
 }
 
-static std::string diagnostics(size_t sc, size_t fc, size_t t, double sr, long long td, double av, std::string m = "default", bool type = false) {
+static bool isMinimal(const std::string& m) {
+  static const std::unordered_set<std::string> aliases = {
+    "minimal", "min", "mn"
+  };
+
+  return aliases.find(m) != aliases.end();
+}
+
+static bool isBand(const std::string& e) {
+  static const std::unordered_set<std::string> aliases = {
+    "band", "table", "b"
+  };
+
+  return aliases.find(e) != aliases.end();
+}
+
+static std::string latency(std::vector<uint32_t>& nanos) {// p50, p99 and worst of per-grid times
+  if (nanos.empty()) return "no grids";
+
+  auto at = [&](double q) {
+    auto it = nanos.begin() + std::min(nanos.size() - 1, size_t(q * double(nanos.size())));
+    std::nth_element(nanos.begin(), it, nanos.end());
+    return double(*it) / 1000;
+  };
+
+  std::ostringstream oss;
+  oss << std::fixed << std::setprecision(1) << "p50 " << at(0.50) << " us, p99 " << at(0.99) << " us, max " << at(1.0) << " us";
+  return oss.str();
+}
+
+static int finish(BlockWriter& console) {// Output that never reached stdout fails the run
+  if (console.flush()) return 0;
+  std::cerr << "Write to stdout failed: " << std::strerror(console.error()) << std::endl;
+  return 1;
+}
+
+static Daemon* service = nullptr;
+
+static void stopService(int) { if (service) service->interrupt(); }
+
+static std::string diagnostics(size_t sc, size_t fc, size_t t, double sr, long long td, double av, std::string m = "default", bool type = false, bool band = false) {
   bool transform = isTransform(m);
   double _td = double (td) / 1000;
   std::ostringstream oss;
 
-  oss << "Mode: " << (transform ? "Transform" : "Default") << " | " << (type ? "Assured" : "Default");
+  oss << "Mode: " << (transform ? "Transform" : "Default") << " | " << (type ? "Assured" : "Default") << " | " << (band ? "Band Table" : "Root Propagation");
   oss << '\n' << std::endl;
   oss << "Total Puzzles: " << t;
   oss << " | ";
@@ -89,12 +149,16 @@ int main(int argc, char* argv[]) {
   //s.printGrid();
 
   
-  size_t count = 999;
+  size_t count = 999, threads = 0, isomorphs = 0, capacity = 65536;
+  uint64_t seed = 0;
 
-  bool verbose = false, assured = false, transform = false, micro = false, pipe = false;
+  bool verbose = false, assured = false, transform = false, micro = false, pipe = false, band = false, seeded = false, drop = false, profile = false, toroidal = false, scramble = false, nosmt = false;
 
   std::string mode = "default";
   std::string bench = "pl";
+  std::string engine = "root";
+  std::string enumerate, corpus, partial, layout, socket, out, format = "line", input, pin = "none";
+  Enumerator::Shard shard;
   
   if (argc > 1) {
     for (int i = 1; i < argc; ++i) {
@@ -102,6 +166,31 @@ int main(int argc, char* argv[]) {
       if (arg == "--count" && ((i + 1) < argc)) count = std::stoul(argv[++i]);
       else if (arg == "--mode" && ((i + 1) < argc)) mode = argv[++i];
       else if (arg == "--bench" && ((i + 1) < argc)) bench = argv[++i];
+      else if (arg == "--engine" && ((i + 1) < argc)) engine = argv[++i];
+      else if (arg == "--enumerate" && ((i + 1) < argc)) enumerate = argv[++i];
+      else if (arg == "--shard" && ((i + 1) < argc)) {
+        std::string spec = argv[++i];
+        size_t slash = spec.find('/');
+        shard.index = std::stoul(spec.substr(0, slash));
+        if (slash != std::string::npos) shard.count = std::stoul(spec.substr(slash + 1));
+      }
+      else if (arg == "--threads" && ((i + 1) < argc)) threads = std::stoul(argv[++i]);
+      else if (arg == "--corpus" && ((i + 1) < argc)) corpus = argv[++i];
+      else if (arg == "--complete" && ((i + 1) < argc)) partial = argv[++i];
+      else if (arg == "--pattern" && ((i + 1) < argc)) layout = argv[++i];
+      else if (arg == "--isomorphs" && ((i + 1) < argc)) isomorphs = std::stoul(argv[++i]);
+      else if (arg == "--daemon" && ((i + 1) < argc)) socket = argv[++i];
+      else if (arg == "--capacity" && ((i + 1) < argc)) capacity = std::stoul(argv[++i]);
+      else if (arg == "--out" && ((i + 1) < argc)) out = argv[++i];
+      else if (arg == "--format" && ((i + 1) < argc)) format = argv[++i];
+      else if (arg == "--drop") drop = true;
+      else if (arg == "--ingest" && ((i + 1) < argc)) input = argv[++i];
+      else if (arg == "--seed" && ((i + 1) < argc)) { seed = std::stoull(argv[++i]); seeded = true; }
+      else if (arg == "--profile") profile = true;
+      else if (arg == "--toroidal") toroidal = true;
+      else if (arg == "--scramble") scramble = true;
+      else if (arg == "--pin" && ((i + 1) < argc)) pin = argv[++i];
+      else if (arg == "--nosmt") nosmt = true;
       else if (arg == "--verbose") verbose = true;
       else if (arg == "--assured") assured = true;
     }
@@ -110,25 +199,271 @@ int main(int argc, char* argv[]) {
   transform = isTransform(mode);
   micro = isMicro(bench);
   pipe = isPipeline(bench);
+  band = isBand(engine);
+
+  if (band) Sudoku().band_generate(); // Build the band table before the clock starts
 
   using clock = std::chrono::steady_clock;
+
+  // A reader that goes away (gen ... | head) must show up as EPIPE from write(), reported and failing the run, not kill it
+  std::signal(SIGPIPE, SIG_IGN);
+
+  // Verbose output is formatted into one block and written in bulk, so printing keeps up with generation
+  BlockWriter console(STDOUT_FILENO);
+
+  if (!enumerate.empty()) {
+    Enumerator walker(enumerate, shard, threads);
+    auto start = clock::now();
+    size_t written = walker.run();
+    double seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+    std::cerr << "Enumerated shard " << shard.index << "/" << shard.count << " into " << enumerate << ": " << walker.unitsDone()
+              << " units, " << written << " grids in " << std::fixed << std::setprecision(2) << seconds << " seconds" << std::endl;
+    return 0;
+  }
   size_t successCount = 0;
   size_t failureCount = 0;
   size_t total = 0;
 
+  if (!partial.empty()) {
+    if (partial.size() < 81) { std::cerr << "--complete expects 81 cells" << std::endl; return 1; }
+
+    for (size_t i = 0; i < count; i++) {
+      if (seeded) reseedThread(seed, i);
+      s.populate(partial);
+
+      auto start = clock::now();
+      bool solved = s.complete();
+      long long took = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count();
+
+      if (!solved) { std::cerr << "No completion exists (" << took << " microseconds)" << std::endl; return 1; }
+      if (verbose) { console.text("\nGrid completion took: " + std::to_string(took) + " microseconds\n"); console.grid(Format::Kind::Pretty, s.getCells()); }
+    }
+
+    return finish(console);
+  }
+
+  if (!layout.empty()) {
+    if (layout.size() < 81) { std::cerr << "--pattern expects 81 cells" << std::endl; return 1; }
+
+    Pattern pattern = Pattern::parse(layout);
+    Sudoku().band_generate(); // Build the band table before the clock starts
+
+    auto start = clock::now();
+    std::vector<Sudoku> puzzles = pattern.generate(count, threads, isomorphs);
+    double seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+    if (verbose) for (auto& p : puzzles) console.grid(Format::Kind::Line, p.getCells());
+    console.flush();
+
+    std::cerr << "Pattern: " << pattern.clues() << " clues | Stabilizer: " << pattern.stabilizer().size() << " | Puzzles: " << puzzles.size()
+              << " from " << pattern.tried() << " grids in " << std::fixed << std::setprecision(2) << seconds << " seconds ("
+              << std::setprecision(1) << (seconds > 0 ? double(puzzles.size()) / seconds : 0.0) << " per second)" << std::endl;
+    return finish(console);
+  }
+
+  if (!socket.empty()) {
+    Daemon::Options options;
+    options.capacity = capacity;
+    options.threads = threads ? threads : 1;
+    options.band = band;
+    options.puzzles = isMinimal(mode);
+
+    Daemon daemon(options);
+    service = &daemon;
+    std::signal(SIGINT, stopService);
+    std::signal(SIGTERM, stopService);
+
+    std::cerr << "Serving " << (options.puzzles ? "minimal puzzles" : "grids") << " on " << socket << std::endl;
+    bool ok = daemon.serve(socket);
+    std::cerr << (ok ? "Stopped: " : "Cannot listen on socket: ") << daemon.metricsLine() << std::endl;
+
+    service = nullptr;
+    return ok ? 0 : 1;
+  }
+
+  if (!input.empty()) {
+    auto start = clock::now();
+    Ingest file(input);
+    if (!file.ok()) { std::cerr << "Cannot read " << input << std::endl; return 1; }
+
+    std::vector<Ingest::Cells> batch(4096);
+    size_t grids = 0, consistent = 0, complete = 0;
+
+    for (size_t n; !console.error() && (n = file.next(batch.data(), batch.size())) > 0;) {
+      for (size_t i = 0; i < n; i++) {
+        s.setCells(batch[i]);
+        consistent += s.isConsistent();
+        complete += s.validateGrid();
+        if (verbose) console.grid(Format::Kind::Pretty, batch[i]);
+      }
+      grids += n;
+    }
+
+    console.flush();
+    double seconds = std::chrono::duration<double>(clock::now() - start).count();
+    std::cerr << "Ingested: " << grids << " grids | Consistent: " << consistent << " | Complete: " << complete << " | Rejected lines: " << file.rejected()
+              << " | " << std::fixed << std::setprecision(3) << seconds << " seconds (" << std::setprecision(1)
+              << (seconds > 0 ? double(file.bytes()) / seconds / 1e6 : 0.0) << " MB/s)" << std::endl;
+    return finish(console);
+  }
+
+  if (!out.empty()) {
+    int fd = (out == "-") ? STDOUT_FILENO : ::open(out.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) { std::cerr << "Cannot open " << out << std::endl; return 1; }
+
+    size_t workers = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+
+    Format::Kind kind;
+    if (!Format::parse(format, kind)) { std::cerr << "Unknown format " << format << std::endl; return 1; }
+
+    Placement::Policy policy;
+    if (!Placement::parse(pin, policy)) { std::cerr << "Unknown placement " << pin << std::endl; return 1; }
+    if (nosmt && policy == Placement::Policy::None) { std::cerr << "--nosmt needs --pin compact or spread" << std::endl; return 1; }
+    Placement placement(policy, nosmt);
+
+    GridWriter writer(fd, workers, kind, drop ? GridWriter::Overflow::Drop : GridWriter::Overflow::Block, 4096, 1 << 20, placement);
+
+    // Per-worker gaps between consecutive grids, each spanning one generation and the hand-off of the one before
+    struct alignas(64) Laps {
+      clock::time_point last;
+      std::vector<uint32_t> nanos;
+    };
+    std::vector<Laps> laps(workers);
+
+    auto lap = [&laps](Sudoku& g, const Stream::Context& at, auto&& next) {
+      Laps& l = laps[at.worker];
+      auto now = clock::now();
+      l.nanos.push_back(uint32_t(std::min<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - l.last).count(), UINT32_MAX)));
+      l.last = now;
+      return next(g);
+    };
+
+    auto start = clock::now();
+    for (Laps& l : laps) l.last = start;
+
+    // Each grid, then --isomorphs distinct images of it. Seeded runs keep index order, so the file is the same
+    // for any --threads and grid i sits at a known place in it
+    auto write = [&](auto grids) {
+      if (isomorphs) (std::move(grids) | Stream::isomorphs(isomorphs) | Stream::write(writer)).run(workers, placement, seeded);
+      else (std::move(grids) | Stream::write(writer)).run(workers, placement, seeded);
+    };
+
+    auto run = [&](auto grids) {
+      if (scramble) write(std::move(grids) | lap | Stream::scramble());
+      else write(std::move(grids) | lap);
+    };
+
+    if (seeded) run(Stream::grids(count, band, true, seed));
+    else run(Stream::grids(count, band));
+
+    writer.close();
+    double seconds = std::chrono::duration<double>(clock::now() - start).count();
+    if (fd != STDOUT_FILENO) ::close(fd);
+
+    GridWriter::Stats st = writer.stats();
+    std::cerr << "Written: " << st.written << " of " << st.submitted << " | Dropped: " << st.dropped << " | Stalls: " << st.stalls
+              << " | " << st.bytes << " bytes in " << st.writes << " writes | " << std::fixed << std::setprecision(2) << seconds << " seconds ("
+              << std::setprecision(0) << (seconds > 0 ? double(st.written) / seconds : 0.0) << " grids per second)" << std::endl;
+
+    std::vector<uint32_t> nanos;
+    for (Laps& l : laps) nanos.insert(nanos.end(), l.nanos.begin(), l.nanos.end());
+    std::cerr << "Placement: " << placement.describe() << " | Per grid: " << latency(nanos) << std::endl;
+
+    if (st.error) { std::cerr << "Write to " << out << " failed: " << std::strerror(st.error) << std::endl; return 1; }
+    return 0;
+  }
+
+  if (toroidal) {
+    Toroidal_Sudoku t;
+    size_t valid = 0;
+
+    auto start = clock::now();
+
+    for (size_t i = 0; i < count; i++) {
+      if (seeded) reseedThread(seed, i);
+
+      t.toroidal_generate(band);
+      valid += t.validateGrid();
+
+      if (verbose) {
+        console.text("Regions offset by " + std::to_string(t.rowOffset()) + " rows, " + std::to_string(t.colOffset()) + " columns\n");
+        console.grid(Format::Kind::Line, t.getCells());
+      }
+    }
+
+    console.flush();
+
+    double seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+    std::cerr << "Mode: Toroidal | " << (band ? "Band Table" : "Root Propagation") << "\n\nValid: " << valid << " of " << count
+              << " | Total Duration: " << std::fixed << std::setprecision(3) << seconds << " seconds | " << std::setprecision(1)
+              << (seconds > 0 ? double(count) / seconds : 0.0) << " per second" << std::endl;
+    return finish(console);
+  }
+
+  if (isMinimal(mode)) {
+    Solver solver;
+    size_t verified = 0, clues = 0;
+
+    auto start = clock::now();
+
+    for (size_t i = 0; i < count; i++) {
+      if (seeded) reseedThread(seed, i);
+
+      do { if (band) s.band_generate(); else s.root_generate(true, s.getBox(i % 9), 8 - (i % 9)); } while (!s.validateGrid());
+
+      std::array<uint8_t, 81> puzzle = solver.minimize(s.getCells());
+      if (!solver.minimal(puzzle)) continue;
+
+      verified++;
+      for (uint8_t v : puzzle) clues += v != 0;
+
+      if (verbose) console.grid(Format::Kind::Line, puzzle);
+    }
+
+    console.flush();
+
+    double seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+    std::cerr << "Mode: Minimal | " << (band ? "Band Table" : "Root Propagation") << "\n\nVerified minimal: " << verified << " of " << count
+              << " | Average clues: " << std::fixed << std::setprecision(2) << (verified ? double(clues) / double(verified) : 0.0)
+              << " | Total Duration: " << seconds << " seconds | " << std::setprecision(1) << (seconds > 0 ? double(verified) / seconds : 0.0)
+              << " per second per core" << std::endl;
+    return finish(console);
+  }
+
+  // Band grids are recorded as 8-byte references (seed index, symmetry code); Sudoku::band_load rebuilds them
+  std::ofstream refs;
+  if (band && !corpus.empty()) refs.open(corpus, std::ios::binary);
+
+  auto band_generate = [&]() {// A corpus needs grids its references rebuild, so it draws straight from the table
+    if (!refs) { s.band_generate(); return; }
+    uint64_t ref = s.band_draw();
+    refs.write(reinterpret_cast<const char*>(&ref), sizeof(ref));
+  };
+
+  // Counters are read around every Root_Propag stage and transform on this thread only
+  if (profile) Perf::enable();
+
   std::chrono::steady_clock::time_point trueStart = clock::now(), end;
   for (size_t i = 0; i < count; i++) {
     long long gridDuration; bool validGrid = false;
     unsigned int tries = 0;
     size_t pos = size_t(i % 9), _pos = 8 - pos;
 
+    if (console.error()) break; // stdout is gone; finish() reports it
+    if (seeded) reseedThread(seed, i); // grid i replays from (seed, i) alone
+
     auto start = clock::now();
 
     if (assured) {
       if (!transform || pipe || !i) {
-        do { s.root_generate(true, s.getBox(pos), _pos); /*s.line_generate();*/ tries++; } while ( !s.validateGrid() );
+        do { if (band) band_generate(); else s.root_generate(true, s.getBox(pos), _pos); /*s.line_generate();*/ tries++; } while ( !s.validateGrid() );
       }
-    } else { if (!transform || pipe || i == 0) s.root_generate(true, s.getBox(pos), _pos); /*s.line_generate();*/ }
+    } else { if (!transform || pipe || i == 0) { if (band) band_generate(); else s.root_generate(true, s.getBox(pos), _pos); /*s.line_generate();*/ } }
+
+    if (scramble && (!transform || pipe || !i)) s.randomizeEquivalent(); // one uniform group element, one pass
 
     end = clock::now();
 
@@ -137,11 +472,11 @@ int main(int argc, char* argv[]) {
     if (verbose) { 
       if (assured) {
         if (micro && i > 0) {} else { 
-          std::cout << '\n' << "Grid completion took: " << gridDuration << " microseconds in " << tries << " tries" << std::endl;
+          console.text("\nGrid completion took: " + std::to_string(gridDuration) + " microseconds in " + std::to_string(tries) + " tries\n");
         }
       } else {
         if (micro && i > 0) {} else { 
-          std::cout << '\n' << "Grid completion took: " << gridDuration << " microseconds" << std::endl;
+          console.text("\nGrid completion took: " + std::to_string(gridDuration) + " microseconds\n");
         }
       }
     }
@@ -149,14 +484,18 @@ int main(int argc, char* argv[]) {
     validGrid = s.validateGrid();
 
     auto printGrid = [&](){
-      if (verbose) s.printGrid();
+      if (verbose) console.grid(Format::Kind::Pretty, s.getCells());
     };
 
     printGrid();
 
     if (validGrid) { successCount++; total = successCount + failureCount; } else { failureCount++; total = successCount + failureCount; continue; }
     
-    if (!i) { _s = s; }
+    if (!i) {
+      _s = s;
+      // A chain of transforms lands back on the base grid (a fail) exactly when its product is one of these
+      if (transform && verbose) console.text("Automorphisms of the base grid: " + std::to_string(Canon::automorphisms(s.getCells()).size()) + "\n");
+    }
 
     if (transform) {
 
@@ -233,6 +572,7 @@ int main(int argc, char* argv[]) {
     }
   }
   end = clock::now();
+  console.flush();
 
   long long totalDuration = std::chrono::duration_cast<std::chrono::milliseconds>(end - trueStart).count();
 
@@ -240,5 +580,7 @@ int main(int argc, char* argv[]) {
 
   double successRate = (total > 0) ? double(successCount) / double(total) : 0.0;
   std::cout << std::endl;
-  std::cerr << diagnostics(successCount, failureCount, count, successRate, totalDuration, average, mode, assured);
+  std::cerr << diagnostics(successCount, failureCount, count, successRate, totalDuration, average, mode, assured, band);
+  if (profile) std::cerr << '\n' << Perf::report();
+  return finish(console);
 }
@@ -0,0 +1,132 @@
+#include "Ingest.h"
+
+#include <cstring>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+	#define INGEST_MMAP 1
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__)
+	#include <immintrin.h>
+#endif
+
+Ingest::Ingest(const std::string& path) {
+#ifdef INGEST_MMAP
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) return;
+
+	struct stat st;
+	if (fstat(fd, &st) == 0 && st.st_size > 0) {
+		void* map = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map != MAP_FAILED) {
+			madvise(map, size_t(st.st_size), MADV_SEQUENTIAL);
+			data = static_cast<const char*>(map);
+			size = size_t(st.st_size);
+			mapped = true;
+		}
+	}
+
+	close(fd);
+	if (mapped) return;
+#endif
+
+	// No mapping (or a pipe): read the whole stream instead
+	std::ifstream in(path, std::ios::binary);
+	if (!in) return;
+
+	std::string all((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	size = all.size();
+	char* copy = new char[size ? size : 1];
+	std::memcpy(copy, all.data(), size);
+	data = copy;
+}
+
+Ingest::~Ingest() {
+#ifdef INGEST_MMAP
+	if (mapped) { munmap(const_cast<char*>(data), size); return; }
+#endif
+	delete[] data;
+}
+
+bool Ingest::decode81(const char* text, uint8_t* cells) {
+	size_t i = 0;
+	bool valid = true;
+
+#if defined(__AVX2__)
+	// value = c - '0'; fine when it is 0..9, or when c is '.', which becomes a blank
+	const __m256i zero = _mm256_set1_epi8('0'), nine = _mm256_set1_epi8(9), dot = _mm256_set1_epi8('.');
+	for (; i + 32 <= 81; i += 32) {
+		__m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+		__m256i v = _mm256_sub_epi8(c, zero);
+		__m256i digit = _mm256_cmpeq_epi8(_mm256_min_epu8(v, nine), v);
+		__m256i blank = _mm256_cmpeq_epi8(c, dot);
+		valid &= _mm256_movemask_epi8(_mm256_or_si256(digit, blank)) == -1;
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(cells + i), _mm256_andnot_si256(blank, v));
+	}
+#endif
+
+#if defined(__SSE2__)
+	const __m128i zero16 = _mm_set1_epi8('0'), nine16 = _mm_set1_epi8(9), dot16 = _mm_set1_epi8('.');
+	for (; i + 16 <= 81; i += 16) {
+		__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+		__m128i v = _mm_sub_epi8(c, zero16);
+		__m128i digit = _mm_cmpeq_epi8(_mm_min_epu8(v, nine16), v);
+		__m128i blank = _mm_cmpeq_epi8(c, dot16);
+		valid &= _mm_movemask_epi8(_mm_or_si128(digit, blank)) == 0xFFFF;
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(cells + i), _mm_andnot_si128(blank, v));
+	}
+#endif
+
+	for (; i < 81; i++) {
+		uint8_t v = uint8_t(text[i] - '0');
+		if (v <= 9) cells[i] = v;
+		else if (text[i] == '.') cells[i] = 0;
+		else valid = false;
+	}
+
+	return valid;
+}
+
+bool Ingest::decodeLoose(const char* text, size_t length, uint8_t* cells) {
+	size_t n = 0;
+
+	for (size_t i = 0; i < length; i++) {
+		char c = text[i];
+		uint8_t v = uint8_t(c - '0');
+
+		if (v <= 9 || c == '.') {
+			if (n == 81) return false;
+			cells[n++] = v <= 9 ? v : 0;
+		}
+		else if (!(c == ' ' || c == '\t' || c == '|' || c == '-' || c == '+' || c == ',' || c == ';')) return false;
+	}
+
+	return n == 81;
+}
+
+size_t Ingest::next(Cells* batch, size_t max) {
+	size_t n = 0;
+
+	while (n < max && pos < size) {
+		const char* line = data + pos;
+		const char* nl = static_cast<const char*>(std::memchr(line, '\n', size - pos));
+		size_t length = nl ? size_t(nl - line) : size - pos;
+		pos += length + (nl ? 1 : 0);
+
+		if (length && line[length - 1] == '\r') length--;
+		if (!length) continue; // blank lines separate nothing
+
+		uint8_t* cells = batch[n].data();
+		bool good = (length == 81 && decode81(line, cells)) || decodeLoose(line, length, cells);
+
+		if (good) n++;
+		else bad++;
+	}
+
+	return n;
+}
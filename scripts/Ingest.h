@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Bulk reader for puzzle files. The file is mapped once and lines are decoded straight into a caller's batch:
+// a bare 81-character line ('1'-'9', '0' or '.' for blanks) takes a vectorized path that converts and validates
+// in one pass, anything else falls back to a scalar scan that skips separators (spaces, tabs, '|', '-', '+',
+// ',', ';'). Lines that don't yield exactly 81 cells, or hold other characters, are counted and skipped.
+class Ingest {
+
+public:
+
+  using Cells = std::array<uint8_t, 81>;
+
+  explicit Ingest(const std::string& path);
+  ~Ingest();
+
+  Ingest(const Ingest&) = delete;
+  Ingest& operator=(const Ingest&) = delete;
+
+  bool ok() const { return data != nullptr; }
+
+  // Decodes up to max grids into batch; 0 once the file is exhausted
+  size_t next(Cells* batch, size_t max);
+
+  size_t rejected() const { return bad; }
+  size_t bytes() const { return size; }
+
+  // One 81-character cell field, converted and validated; false on any other character
+  static bool decode81(const char* text, uint8_t* cells);
+
+  // Separator-tolerant form of one line; false unless exactly 81 cells are found
+  static bool decodeLoose(const char* text, size_t length, uint8_t* cells);
+
+private:
+
+  const char* data = nullptr;
+  size_t size = 0, pos = 0, bad = 0;
+  bool mapped = false;
+};
@@ -0,0 +1,99 @@
+#include "Isomorph.h"
+#include "Symmetry.h"
+#include "Canon.h"
+#include "Solver.h"
+#include "Random.h"
+
+#include <numeric>
+#include <random>
+#include <unordered_map>
+
+using Cells = std::array<uint8_t, 81>;
+
+static bool fixes(const Symmetry& sym, const Cells& cells) {// Whether the image of cells under sym is cells again
+	for (size_t r = 0; r < 9; r++) {
+		for (size_t c = 0; c < 9; c++) {
+			size_t from = sym.transpose ? 9 * sym.cols[c] + sym.rows[r] : 9 * sym.rows[r] + sym.cols[c];
+			if (sym.digits[cells[from]] != cells[9 * r + c]) return false;
+		}
+	}
+	return true;
+}
+
+static bool automorphisms(const Cells& cells, std::vector<Symmetry>& aut) {// A symmetry fixing a unique puzzle carries its solution to a solution, so to the same one
+	thread_local Solver solver;
+	Cells solution = cells;
+
+	if (solver.count(cells, 2) != 1 || !solver.complete(solution)) return false;
+
+	aut.clear();
+	for (const Symmetry& sym : Canon::automorphisms(solution)) {
+		if (fixes(sym, cells)) aut.push_back(sym);
+	}
+	return true;
+}
+
+static size_t sampled(const Sudoku& puzzle, const Cells& source, size_t n, const std::function<void(const Sudoku&, uint64_t)>& emit) {
+	std::uniform_int_distribution<uint64_t> draw(0, Symmetry::codes - 1);
+	Philox& rng = threadRng();
+
+	std::vector<Sudoku> images;
+	std::unordered_map<uint64_t, size_t> seen; // fingerprint -> first image carrying it
+	images.reserve(n + 1);
+	images.push_back(puzzle);
+	seen.emplace(puzzle.fingerprint(), 0);
+
+	// Repeats only pile up for highly symmetric or nearly empty puzzles, so a miss budget ends those runs
+	const size_t maxMisses = 16 * n + 64;
+	Sudoku image;
+
+	for (size_t misses = 0; images.size() <= n && misses < maxMisses;) {
+		uint64_t code = draw(rng);
+		image.gather(source, Symmetry::decode(code));
+
+		auto hit = seen.find(image.fingerprint());
+		if (hit != seen.end() && images[hit->second] == image) { misses++; continue; }
+
+		seen.emplace(image.fingerprint(), images.size());
+		images.push_back(image);
+		emit(image, code);
+	}
+
+	return images.size() - 1;
+}
+
+size_t expandIsomorphs(const Sudoku& puzzle, size_t n, const std::function<void(const Sudoku&, uint64_t)>& emit) {
+	const Cells source = puzzle.getCells();
+
+	std::vector<Symmetry> aut;
+	if (!automorphisms(source, aut)) return sampled(puzzle, source, n, emit);
+
+	// Codes g and a.then(g), a in aut, give the same image, so each image is emitted once, from the least code
+	// mapping to it. Code 0 is the identity and its coset is aut, the images equal to the puzzle.
+	const uint64_t orbit = Symmetry::codes / aut.size();
+	std::uniform_int_distribution<uint64_t> draw(0, Symmetry::codes - 1);
+	Philox& rng = threadRng();
+
+	// A random start and a stride coprime to the code count visit every code once, in scattered order
+	uint64_t code = draw(rng), stride;
+	do { stride = draw(rng); } while (std::gcd(stride, Symmetry::codes) != 1);
+
+	Sudoku image;
+	size_t emitted = 0;
+
+	for (; emitted < n && emitted + 1 < orbit; code = (code + stride) % Symmetry::codes) {
+		if (!code) continue;
+
+		Symmetry sym = Symmetry::decode(code);
+
+		bool least = true;
+		for (size_t a = 1; a < aut.size() && least; a++) least = aut[a].then(sym).encode() > code;
+		if (!least) continue;
+
+		image.gather(source, sym);
+		emit(image, code);
+		emitted++;
+	}
+
+	return emitted;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Sudoku.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// A puzzle's image under one symmetry, with the source puzzle's metadata carried over unchanged
+template <class Meta>
+struct Isomorph {
+  Sudoku puzzle;
+  uint64_t code; // Symmetry::encode() of the map from the source puzzle
+  Meta meta;
+};
+
+// Emits up to n puzzles distinct from each other and from the source. For a full grid or a unique puzzle the
+// automorphism group is computed first (Canon::automorphisms of the solution, kept where it fixes the clues) and
+// the code space is walked from a random start, emitting only the least code of each automorphism coset: every
+// image comes out once with no table, and the orbit has exactly Symmetry::codes / |Aut| members. Puzzles without a
+// unique solution fall back to uniform draws deduplicated by fingerprint. Clue count, uniqueness and difficulty are
+// invariants of the group, so nothing is re-solved or re-rated. Returns how many were emitted, which is below n
+// only when the puzzle's orbit is that small.
+size_t expandIsomorphs(const Sudoku& puzzle, size_t n, const std::function<void(const Sudoku&, uint64_t)>& emit);
+
+template <class Meta>
+std::vector<Isomorph<Meta>> expandIsomorphs(const Sudoku& puzzle, const Meta& meta, size_t n) {
+  std::vector<Isomorph<Meta>> out;
+  out.reserve(n);
+
+  expandIsomorphs(puzzle, n, [&](const Sudoku& image, uint64_t code) { out.push_back({ image, code, meta }); });
+  return out;
+}
@@ -0,0 +1,170 @@
+#include "Pattern.h"
+#include "Solver.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+Pattern::Pattern(const Mask& mask) : layout(mask) {
+	/* --- Stabilizer: image(r, c) = source(rows[r], cols[c]) must equal the layout, source transposed or not --- */
+	auto bitsOf = [&](bool flip) {
+		std::array<uint16_t, 9> rows{};
+		for (size_t r = 0; r < 9; r++) {
+			for (size_t c = 0; c < 9; c++) {
+				if (layout[flip ? 9 * c + r : 9 * r + c]) rows[r] |= uint16_t(1u << c);
+			}
+		}
+		return rows;
+	};
+
+	auto columns = [](const std::array<uint16_t, 9>& rows) {
+		std::array<uint16_t, 9> cols{};
+		for (size_t r = 0; r < 9; r++) {
+			for (size_t c = 0; c < 9; c++) {
+				if (rows[r] & (1u << c)) cols[c] |= uint16_t(1u << r);
+			}
+		}
+		return cols;
+	};
+
+	const std::array<uint16_t, 9> target = columns(bitsOf(false));
+	std::array<uint16_t, 9> sortedTarget = target;
+	std::sort(sortedTarget.begin(), sortedTarget.end());
+
+	std::vector<std::array<uint8_t, 9>> orders(1296);
+	for (uint32_t code = 0; code < 1296; code++) orders[code] = Symmetry::lines(code);
+
+	for (bool flip : { false, true }) {
+		const std::array<uint16_t, 9> source = bitsOf(flip);
+
+		for (const auto& rowOrder : orders) {
+			std::array<uint16_t, 9> moved;
+			for (size_t r = 0; r < 9; r++) moved[r] = source[rowOrder[r]];
+
+			std::array<uint16_t, 9> cols = columns(moved), sortedCols = cols;
+			std::sort(sortedCols.begin(), sortedCols.end());
+			if (sortedCols != sortedTarget) continue;
+
+			for (const auto& colOrder : orders) {
+				bool match = true;
+				for (size_t c = 0; c < 9 && match; c++) match = cols[colOrder[c]] == target[c];
+				if (!match) continue;
+
+				Symmetry sym;
+				sym.rows = rowOrder; sym.cols = colOrder; sym.transpose = flip;
+				stable.push_back(sym);
+				if (stable.size() >= maxStabilizer) return;
+			}
+		}
+	}
+}
+
+Pattern Pattern::parse(const std::string& layout) {
+	bounds_check(layout.size() < 81, "Pattern layout needs 81 cells")
+
+	Mask mask;
+	for (size_t pos = 0; pos < 81; pos++) {
+		char c = layout[pos];
+		mask[pos] = !(c == '.' || c == '0' || c == '-' || c == '_');
+	}
+
+	return Pattern(mask);
+}
+
+bool Pattern::fit(const std::array<uint8_t, 81>& grid, std::array<uint8_t, 81>& puzzle) const {
+	// Two digits absent from the clues can be swapped in any solution
+	uint16_t present = 0;
+	for (size_t pos = 0; pos < 81; pos++) {
+		if (layout[pos]) present |= uint16_t(1u << grid[pos]);
+	}
+	if (std::bitset<16>(present).count() < 8) return false;
+
+	// Unavoidable rectangles: a/b over b/a on two lines of one band (or stack) spanning two boxes; with no clue on
+	// one of them the two digits swap freely there
+	for (size_t flip = 0; flip < 2; flip++) {
+		auto at = [&](size_t r, size_t c) { return flip ? 9 * c + r : 9 * r + c; };
+
+		for (size_t r1 = 0; r1 < 9; r1++) {
+			for (size_t r2 = r1 + 1; r2 < 3 * (r1 / 3) + 3; r2++) {
+				for (size_t c1 = 0; c1 < 9; c1++) {
+					for (size_t c2 = 3 * (c1 / 3) + 3; c2 < 9; c2++) {
+						if (grid[at(r1, c1)] != grid[at(r2, c2)] || grid[at(r1, c2)] != grid[at(r2, c1)]) continue;
+						if (!layout[at(r1, c1)] && !layout[at(r1, c2)] && !layout[at(r2, c1)] && !layout[at(r2, c2)]) return false;
+					}
+				}
+			}
+		}
+	}
+
+	for (size_t pos = 0; pos < 81; pos++) puzzle[pos] = layout[pos] ? grid[pos] : 0;
+
+	thread_local Solver solver;
+	return solver.count(puzzle, 2) == 1;
+}
+
+std::vector<Sudoku> Pattern::generate(size_t count, size_t threads, size_t isomorphs, size_t attempts) const {
+	if (!threads) threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+	if (!attempts) attempts = 20000000 + 2000 * count;
+
+	std::vector<Sudoku> results;
+	std::unordered_multimap<uint64_t, size_t> seen; // fingerprint -> index in results
+	std::mutex lock;
+	std::atomic<size_t> next{ 0 };
+	std::atomic<bool> full{ count == 0 };
+
+	results.reserve(count);
+
+	auto keep = [&](const Sudoku& puzzle) {// Caller holds the lock
+		if (results.size() >= count) return;
+
+		// A fingerprint hit is a repeat only when the cells match too
+		auto hits = seen.equal_range(puzzle.fingerprint());
+		for (auto it = hits.first; it != hits.second; ++it) if (results[it->second] == puzzle) return;
+
+		seen.emplace(puzzle.fingerprint(), results.size());
+		results.push_back(puzzle);
+		if (results.size() >= count) full = true;
+	};
+
+	auto worker = [&]() {
+		Sudoku grid, image;
+		std::array<uint8_t, 81> puzzle;
+		Philox& rng = threadRng();
+
+		while (!full && next++ < attempts) {
+			grid.band_generate();
+			if (!fit(grid.getCells(), puzzle)) continue;
+
+			Sudoku found;
+			found.setCells(puzzle);
+
+			std::lock_guard<std::mutex> guard(lock);
+			keep(found);
+
+			// Stabilizer images keep every clue on the layout; a fresh relabeling makes repeats less likely
+			size_t added = 0;
+			for (size_t i = 0; i < stable.size() && added < isomorphs && !full; i++) {
+				Symmetry sym = stable[i];
+				std::shuffle(sym.digits.begin() + 1, sym.digits.end(), rng);
+				image.gather(puzzle, sym);
+
+				size_t before = results.size();
+				keep(image);
+				added += results.size() - before;
+			}
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (size_t t = 1; t < threads; t++) pool.emplace_back(worker);
+	worker();
+
+	for (auto& t : pool) t.join();
+
+	lastTried = std::min(next.load(), attempts);
+	return results;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Sudoku.h"
+#include "Symmetry.h"
+
+#include <bitset>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Generator of unique puzzles whose clues sit exactly on a fixed layout. Candidates are random symmetry images of
+// band-table grids, screened by cheap necessary conditions (at least 8 distinct clue digits, every unavoidable
+// rectangle of the grid hit by a clue) before a uniqueness count that stops at two solutions. Each hit can be
+// multiplied by the layout's stabilizer, the row/column/transpose maps that carry the layout onto itself.
+class Pattern {
+
+public:
+
+  using Mask = std::bitset<81>; // row-major, set bits are clues
+
+  explicit Pattern(const Mask& mask);
+
+  // 81 characters; '.', '0', '-' and '_' are blanks, anything else marks a clue
+  static Pattern parse(const std::string& layout);
+
+  const Mask& mask() const { return layout; }
+  size_t clues() const { return layout.count(); }
+  const std::vector<Symmetry>& stabilizer() const { return stable; }
+
+  // Masks one grid; true and the puzzle written out when the masked grid has a unique solution
+  bool fit(const std::array<uint8_t, 81>& grid, std::array<uint8_t, 81>& puzzle) const;
+
+  // count puzzles from up to `threads` workers, each hit followed by at most `isomorphs` distinct stabilizer images;
+  // attempts bounds the total candidates so impossible layouts return short
+  std::vector<Sudoku> generate(size_t count, size_t threads = 0, size_t isomorphs = 0, size_t attempts = 0) const;
+
+  // Candidates tried by the last generate() call
+  size_t tried() const { return lastTried; }
+
+private:
+
+  Mask layout;
+  std::vector<Symmetry> stable;
+  mutable size_t lastTried = 0;
+
+  static constexpr size_t maxStabilizer = 4096; // sparse layouts fix millions of maps; a sample is enough
+};
@@ -0,0 +1,244 @@
+#include "Perf.h"
+
+#include <iomanip>
+#include <sstream>
+
+#if defined(__linux__)
+	#include <linux/perf_event.h>
+	#include <sys/ioctl.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+	#include <cerrno>
+	#include <cstring>
+	#define PERF_COUNTERS 1
+#endif
+
+thread_local bool Perf::on = false;
+thread_local std::array<Perf::Totals, Perf::Stages> Perf::table;
+thread_local Perf::Scope* Perf::current = nullptr;
+
+namespace {
+	// One counter group per profiling thread; the leader's group read returns the members in the order they opened
+	struct Group {
+		int leader = -1;
+		std::array<int, Perf::Counters> fds{ -1, -1, -1, -1, -1 };
+		std::array<int8_t, Perf::Counters> slot{ -1, -1, -1, -1, -1 };
+		size_t opened = 0;
+		Perf::Totals overhead; // one empty scope, subtracted per call in the report
+		std::string status = "profiling disabled";
+
+		~Group() { close(); }
+
+		void close() {
+#ifdef PERF_COUNTERS
+			for (int& fd : fds) { if (fd >= 0) ::close(fd); fd = -1; }
+#endif
+			leader = -1; slot.fill(-1); opened = 0;
+		}
+	};
+
+	thread_local Group group;
+
+	const char* const stageNames[Perf::Stages] = {
+		"Root_Propag 1 (root box)", "Root_Propag 2 (adjacent)", "Root_Propag 3 (non-adjacent)", "NonAdjFill", "Phistemofel",
+		"torShift", "bandSwap", "stackSwap", "bandRowSwap", "stackColSwap",
+		"transpose", "_transpose", "reflection", "rotation", "_rotation", "digPermut"
+	};
+
+	const char* const counterNames[Perf::Counters] = { "instructions", "cycles", "L1D misses", "LLC misses", "branch misses" };
+
+#ifdef PERF_COUNTERS
+	int open(uint32_t type, uint64_t config, int leader) {// User-space only, so perf_event_paranoid 2 still allows it
+		perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = type;
+		attr.config = config;
+		attr.read_format = PERF_FORMAT_GROUP;
+		attr.disabled = leader < 0;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+
+		return int(syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+	}
+
+	constexpr uint64_t cacheMiss(uint64_t cache) {
+		return cache | (uint64_t(PERF_COUNT_HW_CACHE_OP_READ) << 8) | (uint64_t(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16);
+	}
+#endif
+}
+
+bool Perf::enable() {
+	reset();
+	group.close();
+	group.status.clear();
+	on = true;
+
+#ifdef PERF_COUNTERS
+	const std::array<std::pair<uint32_t, uint64_t>, Counters> events = {{
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+		{ PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_L1D) },
+		{ PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_LL) },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+	}};
+
+	int error = 0;
+	std::string missing;
+
+	// Members the PMU lacks (LLC events on some parts) are left out rather than failing the group
+	for (size_t c = 0; c < Counters; c++) {
+		int fd = open(events[c].first, events[c].second, group.leader);
+		if (fd < 0) {
+			if (!error) error = errno;
+			missing += std::string(missing.empty() ? "" : ", ") + counterNames[c];
+			continue;
+		}
+		if (group.leader < 0) group.leader = fd;
+		group.fds[c] = fd;
+		group.slot[c] = int8_t(group.opened++);
+	}
+
+	if (group.leader >= 0) {
+		ioctl(group.leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(group.leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+		// A group the PMU cannot schedule opens fine but never counts
+		std::array<uint64_t, Counters> a, b;
+		volatile uint64_t spin = 0;
+		sample(a);
+		for (int i = 0; i < 10000; i++) spin = spin + i;
+		if (!sample(b) || (b[Instructions] == a[Instructions] && b[Cycles] == a[Cycles])) {
+			group.close();
+			group.status = "hardware counters opened but are not counting; timing only";
+		}
+	}
+
+	if (group.leader < 0) {
+		if (group.status.empty()) {
+			group.status = std::string("perf_event_open failed (") + std::strerror(error) + ")";
+			if (error == EACCES || error == EPERM) group.status += ", check /proc/sys/kernel/perf_event_paranoid";
+			group.status += "; timing only";
+		}
+	} else {
+		group.status = "hardware counters: " + std::to_string(group.opened) + " of " + std::to_string(size_t(Counters));
+		if (!missing.empty()) group.status += " (unavailable: " + missing + ")";
+	}
+#else
+	group.status = "hardware counters need Linux perf_event_open; timing only";
+#endif
+
+	// Calibrate the cost of an empty scope on this thread, so tiny stages aren't dominated by the two reads
+	const size_t rounds = 1000;
+	for (size_t i = 0; i < rounds; i++) { Scope empty(RootFill); }
+
+	Totals& t = table[RootFill];
+	group.overhead.calls = 1;
+	group.overhead.nanos = t.nanos / rounds;
+	for (size_t c = 0; c < Counters; c++) group.overhead.counts[c] = t.counts[c] / rounds;
+	t = Totals();
+
+	return group.leader >= 0;
+}
+
+void Perf::disable() {
+	on = false;
+	group.close();
+}
+
+const std::string& Perf::status() { return group.status; }
+
+const char* Perf::name(Stage stage) { return stage < Stages ? stageNames[stage] : "?"; }
+
+void Perf::reset() { table.fill(Totals()); }
+
+bool Perf::sample(std::array<uint64_t, Counters>& values) {// One read() of the whole group
+	values.fill(0);
+#ifdef PERF_COUNTERS
+	if (group.leader < 0) return false;
+
+	uint64_t buffer[1 + Counters];
+	ssize_t got = ::read(group.leader, buffer, sizeof(buffer));
+	if (got < ssize_t(sizeof(uint64_t))) return false;
+
+	for (size_t c = 0; c < Counters; c++) {
+		if (group.slot[c] >= 0 && size_t(group.slot[c]) < buffer[0]) values[c] = buffer[1 + group.slot[c]];
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+void Perf::Scope::begin() {
+	parent = current;
+	current = this;
+	sample(first);
+	start = std::chrono::steady_clock::now(); // after the read, so the timing excludes it
+}
+
+void Perf::Scope::end() {
+	auto stop = std::chrono::steady_clock::now();
+	std::array<uint64_t, Counters> last;
+	sample(last);
+
+	current = parent;
+
+	// Inclusive figures go up to the parent; this stage keeps what its children didn't measure
+	auto exclusive = [](uint64_t all, uint64_t nested) { return all > nested ? all - nested : 0; };
+	uint64_t nanos = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+
+	Totals& t = table[stage];
+	t.calls++;
+	t.nanos += exclusive(nanos, childNanos);
+	if (parent) parent->childNanos += nanos;
+
+	for (size_t c = 0; c < Counters; c++) {
+		uint64_t count = last[c] - first[c];
+		t.counts[c] += exclusive(count, childCounts[c]);
+		if (parent) parent->childCounts[c] += count;
+	}
+}
+
+std::string Perf::report() {
+	std::ostringstream oss;
+	bool counters = group.leader >= 0;
+
+	auto perOp = [](uint64_t total, uint64_t calls, uint64_t overhead) {
+		double v = double(total) / double(calls) - double(overhead);
+		return v > 0 ? v : 0.0;
+	};
+
+	oss << "Profile: " << group.status << '\n';
+	oss << std::left << std::setw(30) << "Stage" << std::right << std::setw(10) << "Calls" << std::setw(12) << "ns/op";
+	if (counters) {
+		oss << std::setw(12) << "instr/op" << std::setw(12) << "cycles/op" << std::setw(8) << "IPC"
+		    << std::setw(12) << "L1D miss" << std::setw(12) << "LLC miss" << std::setw(12) << "br miss";
+	}
+	oss << '\n';
+
+	oss << std::fixed;
+	for (size_t s = 0; s < Stages; s++) {
+		const Totals& t = table[s];
+		if (!t.calls) continue;
+
+		oss << std::left << std::setw(30) << stageNames[s] << std::right << std::setw(10) << t.calls
+		    << std::setw(12) << std::setprecision(1) << perOp(t.nanos, t.calls, group.overhead.nanos);
+
+		if (counters) {
+			std::array<double, Counters> v;
+			for (size_t c = 0; c < Counters; c++) v[c] = perOp(t.counts[c], t.calls, group.overhead.counts[c]);
+
+			oss << std::setw(12) << std::setprecision(1) << v[Instructions] << std::setw(12) << v[Cycles]
+			    << std::setw(8) << std::setprecision(2) << (v[Cycles] > 0 ? v[Instructions] / v[Cycles] : 0.0)
+			    << std::setprecision(2) << std::setw(12) << v[L1DMisses] << std::setw(12) << v[LLCMisses] << std::setw(12) << v[BranchMisses];
+		}
+		oss << '\n';
+	}
+
+	oss << "Stages are exclusive of the stages they call; per-op figures are net of an empty scope (" << group.overhead.nanos << " ns";
+	if (counters) oss << ", " << group.overhead.counts[Instructions] << " instructions";
+	oss << ")\n";
+
+	return oss.str();
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Per-stage hardware counters for the benchmark driver. Once a thread calls enable(), every Perf::Scope on that
+// thread reads one perf_event_open group (instructions, cycles, L1D read misses, LLC read misses, branch misses)
+// on entry and exit and adds the difference to its stage. Scopes nest and stages are exclusive: what a nested scope
+// measured is taken off the scope around it, so every cycle is counted in one stage and the rows add up.
+// Without counters (non-Linux, perf_event_paranoid, no PMU in a VM) only wall time is kept; on threads that never
+// enabled profiling a scope is one thread-local test.
+class Perf {
+
+public:
+
+  enum Stage : uint8_t {
+    RootFill, AdjacentFill, NonAdjacentFill, NonAdjFill, Phistemofel,
+    TorShift, BandSwap, StackSwap, BandRowSwap, StackColSwap,
+    Transpose, InverseTranspose, Reflection, Rotation, InverseRotation, DigPermut,
+    Stages
+  };
+
+  enum Counter : uint8_t { Instructions, Cycles, L1DMisses, LLCMisses, BranchMisses, Counters };
+
+  struct Totals {
+    uint64_t calls = 0, nanos = 0;
+    std::array<uint64_t, Counters> counts{};
+  };
+
+  // Starts profiling on the calling thread; false when only timing is available (see status())
+  static bool enable();
+  static void disable();
+  static bool enabled() { return on; }
+
+  // Which counters opened, or why none did
+  static const std::string& status();
+
+  static const char* name(Stage stage);
+  static const Totals& totals(Stage stage) { return table[stage]; }
+  static void reset();
+
+  // Per-operation table of every stage that ran, net of the measured cost of an empty scope
+  static std::string report();
+
+  class Scope {
+
+  public:
+
+    explicit Scope(Stage s) : stage(s), active(on) { if (active) begin(); }
+    ~Scope() { if (active) end(); }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+
+    Stage stage;
+    bool active;
+    Scope* parent = nullptr;
+    std::chrono::steady_clock::time_point start;
+    std::array<uint64_t, Counters> first;
+    uint64_t childNanos = 0;                      // measured by scopes nested in this one
+    std::array<uint64_t, Counters> childCounts{};
+
+    void begin();
+    void end();
+  };
+
+private:
+
+  static thread_local bool on;
+  static thread_local std::array<Totals, Stages> table;
+  static thread_local Scope* current; // innermost open scope
+
+  static bool sample(std::array<uint64_t, Counters>& values);
+};
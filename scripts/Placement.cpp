@@ -0,0 +1,180 @@
+#include "Placement.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <thread>
+
+#if defined(__linux__)
+	#include <pthread.h>
+	#include <sched.h>
+	#define PLACEMENT_AFFINITY 1
+#endif
+
+namespace {
+	int readInt(const std::string& path, int fallback) {
+		std::ifstream in(path);
+		int value;
+		return (in >> value) ? value : fallback;
+	}
+
+	std::vector<int> readList(const std::string& path) {// sysfs cpu lists: "0-3,8-11"
+		std::vector<int> out;
+		std::ifstream in(path);
+		std::string spec;
+		if (!(in >> spec)) return out;
+
+		size_t at = 0;
+		while (at < spec.size()) {
+			size_t comma = spec.find(',', at);
+			if (comma == std::string::npos) comma = spec.size();
+
+			std::string range = spec.substr(at, comma - at);
+			size_t dash = range.find('-');
+			int lo = std::stoi(range.substr(0, dash));
+			int hi = dash == std::string::npos ? lo : std::stoi(range.substr(dash + 1));
+			for (int c = lo; c <= hi; c++) out.push_back(c);
+
+			at = comma + 1;
+		}
+		return out;
+	}
+
+	std::vector<Placement::Cpu> probe() {
+		std::vector<int> allowed;
+#ifdef PLACEMENT_AFFINITY
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+			for (int c = 0; c < CPU_SETSIZE; c++) if (CPU_ISSET(c, &set)) allowed.push_back(c);
+		}
+#endif
+		if (allowed.empty()) {
+			for (unsigned c = 0; c < std::max(1u, std::thread::hardware_concurrency()); c++) allowed.push_back(int(c));
+		}
+
+		// Node of every CPU from the node cpulists; machines without them are one node
+		std::vector<int> nodeOf(size_t(allowed.back()) + 1, 0);
+		for (int n : readList("/sys/devices/system/node/online")) {
+			for (int c : readList("/sys/devices/system/node/node" + std::to_string(n) + "/cpulist")) {
+				if (size_t(c) < nodeOf.size()) nodeOf[c] = n;
+			}
+		}
+
+		std::vector<Placement::Cpu> cpus;
+		std::set<std::pair<int, int>> seen; // (package, core) pairs whose first thread is already listed
+
+		for (int c : allowed) {
+			std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(c) + "/topology/";
+			Placement::Cpu cpu;
+			cpu.id = c;
+			cpu.package = readInt(base + "physical_package_id", 0);
+			cpu.core = readInt(base + "core_id", c);
+			cpu.node = nodeOf[c];
+			cpu.primary = seen.insert({ cpu.package, cpu.core }).second;
+			cpus.push_back(cpu);
+		}
+
+		return cpus;
+	}
+}
+
+Placement::Placement(Policy policy, bool noSmt) : policy(policy), noSmt(noSmt && policy != Policy::None) {
+	if (policy == Policy::None) return;
+
+	std::vector<Cpu> cpus = topology();
+	if (noSmt) {
+		std::vector<Cpu> primaries;
+		std::copy_if(cpus.begin(), cpus.end(), std::back_inserter(primaries), [](const Cpu& c) { return c.primary; });
+		if (!primaries.empty()) cpus = primaries;
+	}
+
+	// Compact order: node, package, core, then hardware thread (ids rise with the thread on every layout we know)
+	std::stable_sort(cpus.begin(), cpus.end(), [](const Cpu& a, const Cpu& b) {
+		if (a.node != b.node) return a.node < b.node;
+		if (a.package != b.package) return a.package < b.package;
+		return a.core < b.core;
+	});
+
+	if (policy == Policy::Spread) {// Deal the compact order out over the nodes, first CPU of each node first
+		std::vector<std::vector<Cpu>> byNode;
+		for (const Cpu& c : cpus) {
+			if (byNode.empty() || byNode.back().front().node != c.node) byNode.emplace_back();
+			byNode.back().push_back(c);
+		}
+
+		// Within a node, one thread per core before any sibling
+		for (auto& list : byNode) std::stable_partition(list.begin(), list.end(), [](const Cpu& c) { return c.primary; });
+
+		cpus.clear();
+		for (size_t i = 0, dealt = 1; dealt; i++) {
+			dealt = 0;
+			for (auto& list : byNode) if (i < list.size()) { cpus.push_back(list[i]); dealt++; }
+		}
+	}
+
+	order = cpus;
+}
+
+bool Placement::parse(const std::string& name, Policy& policy) {
+	if (name == "none") policy = Policy::None;
+	else if (name == "compact") policy = Policy::Compact;
+	else if (name == "spread") policy = Policy::Spread;
+	else return false;
+	return true;
+}
+
+const char* Placement::name(Policy policy) {
+	switch (policy) {
+		case Policy::Compact: return "compact";
+		case Policy::Spread: return "spread";
+		default: return "none";
+	}
+}
+
+const std::vector<Placement::Cpu>& Placement::topology() {
+	static const std::vector<Cpu> cpus = probe();
+	return cpus;
+}
+
+size_t Placement::nodes() {
+	std::set<int> seen;
+	for (const Cpu& c : topology()) seen.insert(c.node);
+	return seen.size();
+}
+
+int Placement::cpu(size_t worker) const { return pins() ? order[worker % order.size()].id : -1; }
+
+int Placement::node(size_t worker) const { return pins() ? order[worker % order.size()].node : -1; }
+
+bool Placement::pin(size_t worker) const {
+#ifdef PLACEMENT_AFFINITY
+	if (!pins()) return false;
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu(worker), &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	(void)worker;
+	return false;
+#endif
+}
+
+void Placement::local(size_t worker, const std::function<void()>& fn) const {
+	if (!pins()) { fn(); return; }
+
+	std::thread t([&] { pin(worker); fn(); });
+	t.join();
+}
+
+std::string Placement::describe() const {
+	std::string out = name(policy);
+	if (noSmt) out += ", no SMT";
+	if (!pins()) return out;
+
+	std::set<int> spanned;
+	for (const Cpu& c : order) spanned.insert(c.node);
+	return out + " (" + std::to_string(order.size()) + (order.size() == 1 ? " CPU on " : " CPUs on ") + std::to_string(spanned.size()) + " of " + std::to_string(nodes()) + " nodes)";
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Worker placement for the parallel paths. The machine layout (logical CPUs the process may run on, their physical
+// core, package and NUMA node) is read once from /sys; a policy turns it into an ordered list of CPUs and worker w
+// is pinned to entry w (wrapping when there are more workers than CPUs):
+//
+//   none     no pinning, the scheduler decides (the default)
+//   compact  fill one node before the next, hardware threads of a core next to each other
+//   spread   round-robin over the nodes, so every memory controller and L3 takes its share
+//
+// With noSmt compact and spread use only the first hardware thread of each core; none ignores it. Memory is placed by first touch: buffers a worker
+// allocates and writes after pin() live on its node, and local() builds shared per-worker buffers (output rings)
+// from a thread pinned like that worker. Without Linux affinity calls every policy behaves as none.
+class Placement {
+
+public:
+
+  enum class Policy { None, Compact, Spread };
+
+  struct Cpu {
+    int id, core, package, node;
+    bool primary; // first hardware thread of its core
+  };
+
+  Placement() = default;
+  Placement(Policy policy, bool noSmt = false);
+
+  // none/compact/spread; false for anything else
+  static bool parse(const std::string& name, Policy& policy);
+  static const char* name(Policy policy);
+
+  // Allowed CPUs in id order, with their cores and nodes
+  static const std::vector<Cpu>& topology();
+  static size_t nodes();
+
+  bool pins() const { return !order.empty(); }
+
+  // CPU and node for worker w, -1 when unpinned
+  int cpu(size_t worker) const;
+  int node(size_t worker) const;
+
+  // Pins the calling thread as worker w; false when unpinned or the kernel refused
+  bool pin(size_t worker) const;
+
+  // Runs fn on a thread pinned as worker w and waits for it, so whatever fn allocates and touches is local to w
+  void local(size_t worker, const std::function<void()>& fn) const;
+
+  // Policy, CPUs used and nodes spanned, for run summaries
+  std::string describe() const;
+
+private:
+
+  Policy policy = Policy::None;
+  bool noSmt = false;
+  std::vector<Cpu> order;
+};
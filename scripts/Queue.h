@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Bounded multi-producer multi-consumer queue (Dmitry Vyukov's array design). Each slot carries a sequence
+// number that tells producers and consumers whose turn it is, so both sides claim slots with one CAS and never
+// take a lock. Capacity is rounded up to a power of two.
+template <class T>
+class BoundedQueue {
+
+public:
+
+  explicit BoundedQueue(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) size <<= 1;
+
+    mask = size - 1;
+    slots.reset(new Slot[size]);
+    for (size_t i = 0; i < size; i++) slots[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+  BoundedQueue(const BoundedQueue&) = delete;
+  BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+  bool push(const T& value) {
+    size_t pos = tail.load(std::memory_order_relaxed);
+
+    for (;;) {
+      Slot& slot = slots[pos & mask];
+      size_t seq = slot.seq.load(std::memory_order_acquire);
+      intptr_t diff = intptr_t(seq) - intptr_t(pos);
+
+      if (!diff) {
+        if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          slot.value = value;
+          slot.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (diff < 0) return false; // full
+      else pos = tail.load(std::memory_order_relaxed);
+    }
+  }
+
+  bool pop(T& value) {
+    size_t pos = head.load(std::memory_order_relaxed);
+
+    for (;;) {
+      Slot& slot = slots[pos & mask];
+      size_t seq = slot.seq.load(std::memory_order_acquire);
+      intptr_t diff = intptr_t(seq) - intptr_t(pos + 1);
+
+      if (!diff) {
+        if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          value = slot.value;
+          slot.seq.store(pos + mask + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (diff < 0) return false; // empty
+      else pos = head.load(std::memory_order_relaxed);
+    }
+  }
+
+  // Racy snapshot, good enough for watermarks and metrics
+  size_t size() const {
+    size_t t = tail.load(std::memory_order_relaxed), h = head.load(std::memory_order_relaxed);
+    return t > h ? t - h : 0;
+  }
+
+  size_t capacity() const { return mask + 1; }
+
+private:
+
+  struct Slot {
+    std::atomic<size_t> seq;
+    T value;
+  };
+
+  std::unique_ptr<Slot[]> slots;
+  size_t mask = 0;
+
+  alignas(64) std::atomic<size_t> tail{ 0 }; // producers
+  alignas(64) std::atomic<size_t> head{ 0 }; // consumers
+};
+
+// Bounded single-producer single-consumer ring. Each side owns one index and keeps a cached copy of the other's,
+// so the shared cache lines are only touched when the cached view says the ring looks full or empty.
+template <class T>
+class SpscRing {
+
+public:
+
+  explicit SpscRing(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) size <<= 1;
+
+    mask = size - 1;
+    slots.reset(new T[size]()); // zeroed here, so the constructing thread first-touches the pages
+  }
+
+  SpscRing(const SpscRing&) = delete;
+  SpscRing& operator=(const SpscRing&) = delete;
+
+  bool push(const T& value) {// Producer thread only
+    size_t t = tail.load(std::memory_order_relaxed);
+
+    if (t - headCache > mask) {
+      headCache = head.load(std::memory_order_acquire);
+      if (t - headCache > mask) return false;
+    }
+
+    slots[t & mask] = value;
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T& value) {// Consumer thread only
+    size_t h = head.load(std::memory_order_relaxed);
+
+    if (h == tailCache) {
+      tailCache = tail.load(std::memory_order_acquire);
+      if (h == tailCache) return false;
+    }
+
+    value = slots[h & mask];
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+  size_t capacity() const { return mask + 1; }
+
+private:
+
+  std::unique_ptr<T[]> slots;
+  size_t mask = 0;
+
+  alignas(64) std::atomic<size_t> tail{ 0 };
+  size_t headCache = 0; // producer's view of head
+  alignas(64) std::atomic<size_t> head{ 0 };
+  size_t tailCache = 0; // consumer's view of tail
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3"). Every
+// block of four outputs is a pure function of (key, counter), so keying by a global seed and running the counter
+// from the head of a stream (one stream per grid index) makes a draw independent of which thread runs it.
+class Philox {
+
+public:
+
+  using result_type = uint32_t;
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  explicit Philox(uint64_t seed = 0, uint64_t stream = 0) { reseed(seed, stream); }
+
+  // Key by seed and rewind to the first block of stream
+  void reseed(uint64_t seed, uint64_t stream) {
+    key = { uint32_t(seed), uint32_t(seed >> 32) };
+    counter = { 0, 0, uint32_t(stream), uint32_t(stream >> 32) };
+    used = 4;
+  }
+
+  result_type operator()() {
+    if (used == 4) { block = encrypt(counter, key); advance(); used = 0; }
+    return block[used++];
+  }
+
+  void discard(uint64_t n) { while (n--) (*this)(); }
+
+  // Single-block evaluation, exposed so known-answer vectors can be checked
+  static std::array<uint32_t, 4> encrypt(std::array<uint32_t, 4> ctr, std::array<uint32_t, 2> k) {
+    for (int round = 0; round < 10; round++) {
+      if (round) { k[0] += 0x9E3779B9u; k[1] += 0xBB67AE85u; }
+
+      uint64_t p0 = uint64_t(0xD2511F53u) * ctr[0], p1 = uint64_t(0xCD9E8D57u) * ctr[2];
+      ctr = { uint32_t(p1 >> 32) ^ ctr[1] ^ k[0], uint32_t(p1), uint32_t(p0 >> 32) ^ ctr[3] ^ k[1], uint32_t(p0) };
+    }
+    return ctr;
+  }
+
+private:
+
+  std::array<uint32_t, 2> key{};
+  std::array<uint32_t, 4> counter{}, block{};
+  unsigned used = 4;
+
+  void advance() { if (!++counter[0]) ++counter[1]; } // the low half counts blocks inside a stream
+};
+
+// Per-thread generator behind every engine, so helper modules draw from the same stream as Sudoku. It is keyed
+// from std::random_device until reseedThread() pins it.
+Philox& threadRng();
+
+// Re-key the calling thread's generator to (seed, index); the same pair always replays the same draws
+void reseedThread(uint64_t seed, uint64_t index);
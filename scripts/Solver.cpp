@@ -0,0 +1,242 @@
+#include "Solver.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <bitset>
+
+static constexpr size_t boxOf(size_t pos) { return 3 * (pos / 27) + (pos % 9) / 3; }
+
+// Row-major positions of the 27 units: rows, then columns, then boxes
+static constexpr std::array<std::array<uint8_t, 9>, 27> units = [] {
+	std::array<std::array<uint8_t, 9>, 27> out{};
+
+	for (size_t u = 0; u < 9; u++) {
+		for (size_t i = 0; i < 9; i++) {
+			out[u][i] = uint8_t(9 * u + i);
+			out[9 + u][i] = uint8_t(9 * i + u);
+			out[18 + u][i] = uint8_t(27 * (u / 3) + 3 * (u % 3) + 9 * (i / 3) + i % 3);
+		}
+	}
+
+	return out;
+}();
+
+static constexpr uint16_t allDigits = 0x3FE;
+
+void Solver::place(size_t pos, uint8_t val) {
+	uint16_t bit = uint16_t(1u << val);
+	rows[pos / 9] |= bit; cols[pos % 9] |= bit; boxes[boxOf(pos)] |= bit;
+	grid[pos] = val;
+	trail[depth++] = uint8_t(pos);
+}
+
+void Solver::undo(size_t mark) {
+	while (depth > mark) {
+		size_t pos = trail[--depth];
+		uint16_t keep = uint16_t(~(1u << grid[pos]));
+		rows[pos / 9] &= keep; cols[pos % 9] &= keep; boxes[boxOf(pos)] &= keep;
+		grid[pos] = 0;
+	}
+}
+
+uint16_t Solver::candidates(size_t pos) const {
+	return uint16_t(~(rows[pos / 9] | cols[pos % 9] | boxes[boxOf(pos)] | banned[pos]) & allDigits);
+}
+
+bool Solver::load(const Cells& cells) {// Seed the unit masks from the clues, rejecting clues that already clash
+	rows.fill(0); cols.fill(0); boxes.fill(0);
+	grid.fill(0);
+	banned.fill(0);
+	depth = 0;
+
+	for (size_t pos = 0; pos < 81; pos++) {
+		uint8_t val = cells[pos];
+		if (!val) continue;
+		if (val > 9 || !(candidates(pos) & (1u << val))) return false;
+		place(pos, val);
+	}
+
+	depth = 0; // clues stay off the trail, so no search unwinds them
+	return true;
+}
+
+bool Solver::propagate() {// Naked and hidden singles until nothing changes; false on a dead end
+	for (bool changed = true; changed;) {
+		changed = false;
+
+		for (size_t pos = 0; pos < 81; pos++) {
+			if (grid[pos]) continue;
+
+			uint16_t mask = candidates(pos);
+			if (!mask) return false;
+			if (mask & (mask - 1)) continue;
+
+			place(pos, uint8_t(__builtin_ctz(mask)));
+			changed = true;
+		}
+
+		for (const auto& unit : units) {
+			uint16_t once = 0, twice = 0, placed = 0;
+
+			for (uint8_t pos : unit) {
+				if (grid[pos]) { placed |= uint16_t(1u << grid[pos]); continue; }
+				uint16_t mask = candidates(pos);
+				twice |= once & mask;
+				once |= mask;
+			}
+
+			if ((once | placed) != allDigits) return false; // a missing digit has nowhere to go
+
+			for (uint16_t single = uint16_t(once & ~twice & ~placed); single; single &= uint16_t(single - 1)) {
+				uint8_t val = uint8_t(__builtin_ctz(single));
+
+				for (uint8_t pos : unit) {
+					if (grid[pos] || !(candidates(pos) & (1u << val))) continue;
+					place(pos, val);
+					changed = true;
+					break;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+bool Solver::search() {// Propagate, then branch on the most constrained blank with digits in random order
+	size_t mark = depth;
+	if (!propagate()) { undo(mark); return false; }
+
+	size_t best = 81, bestCount = 10;
+
+	for (size_t pos = 0; pos < 81; pos++) {
+		if (grid[pos]) continue;
+
+		size_t count = std::bitset<16>(candidates(pos)).count();
+		if (count < bestCount) {
+			best = pos; bestCount = count;
+			if (count <= 2) break;
+		}
+	}
+
+	if (best == 81) return true;
+
+	std::array<uint8_t, 9> order;
+	size_t n = 0;
+	uint16_t mask = candidates(best);
+
+	for (uint8_t d = 1; d <= 9; d++) {
+		if (mask & (1u << d)) order[n++] = d;
+	}
+
+	std::shuffle(order.begin(), order.begin() + n, threadRng());
+
+	for (size_t i = 0; i < n; i++) {
+		size_t branch = depth;
+		place(best, order[i]);
+		if (search()) return true;
+		undo(branch);
+	}
+
+	undo(mark);
+	return false;
+}
+
+size_t Solver::countFrom(size_t limit) {// Same propagation, digits in fixed order, stops once limit completions are seen
+	size_t mark = depth;
+	if (!propagate()) { undo(mark); return 0; }
+
+	size_t best = 81, bestCount = 10;
+
+	for (size_t pos = 0; pos < 81; pos++) {
+		if (grid[pos]) continue;
+
+		size_t count = std::bitset<16>(candidates(pos)).count();
+		if (count < bestCount) {
+			best = pos; bestCount = count;
+			if (count <= 2) break;
+		}
+	}
+
+	size_t found = 0;
+
+	if (best == 81) found = 1;
+	else {
+		uint16_t mask = candidates(best);
+
+		for (uint8_t d = 1; d <= 9 && found < limit; d++) {
+			if (!(mask & (1u << d))) continue;
+
+			size_t branch = depth;
+			place(best, d);
+			found += countFrom(limit - found);
+			undo(branch);
+		}
+	}
+
+	undo(mark);
+	return found;
+}
+
+size_t Solver::count(const Cells& cells, size_t limit) {
+	if (!limit || !load(cells)) return 0;
+	return countFrom(limit);
+}
+
+bool Solver::needed(size_t pos) {// A clue is needed when some completion of the other clues puts a different digit there
+	uint8_t val = grid[pos];
+	uint16_t bit = uint16_t(1u << val), keep = uint16_t(~bit);
+
+	rows[pos / 9] &= keep; cols[pos % 9] &= keep; boxes[boxOf(pos)] &= keep;
+	grid[pos] = 0;
+	banned[pos] = bit;
+
+	// The other clues' masks are shared by every check; only this cell's digit comes and goes
+	bool other = countFrom(1) != 0;
+
+	banned[pos] = 0;
+	rows[pos / 9] |= bit; cols[pos % 9] |= bit; boxes[boxOf(pos)] |= bit;
+	grid[pos] = val;
+
+	return other;
+}
+
+Solver::Cells Solver::minimize(const Cells& cells) {
+	if (!load(cells)) return cells;
+
+	std::array<uint8_t, 81> order;
+	size_t n = 0;
+	for (size_t pos = 0; pos < 81; pos++) {
+		if (grid[pos]) order[n++] = uint8_t(pos);
+	}
+
+	std::shuffle(order.begin(), order.begin() + n, threadRng());
+
+	for (size_t i = 0; i < n; i++) {
+		size_t pos = order[i];
+		if (needed(pos)) continue;
+
+		uint16_t keep = uint16_t(~(1u << grid[pos]));
+		rows[pos / 9] &= keep; cols[pos % 9] &= keep; boxes[boxOf(pos)] &= keep;
+		grid[pos] = 0;
+	}
+
+	return grid;
+}
+
+bool Solver::minimal(const Cells& cells) {
+	if (count(cells, 2) != 1 || !load(cells)) return false;
+
+	for (size_t pos = 0; pos < 81; pos++) {
+		if (grid[pos] && !needed(pos)) return false;
+	}
+
+	return true;
+}
+
+bool Solver::complete(Cells& cells) {
+	if (!load(cells) || !search()) return false;
+
+	cells = grid;
+	return true;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Bitmask search over a row-major grid, used to complete partial grids that the propagation engines can't seed.
+// Every node runs naked and hidden singles to a fixpoint and fails as soon as a blank has no candidate or a unit
+// has no room left for a missing digit, so contradictory clues are rejected without branching.
+class Solver {
+
+public:
+
+  using Cells = std::array<uint8_t, 81>;
+
+  // Fills every blank with a randomly ordered search; false when the clues admit no completion
+  bool complete(Cells& cells);
+
+  // Number of completions, counted up to limit (2 answers "is it unique?"); 0 when the clues clash
+  size_t count(const Cells& cells, size_t limit = 2);
+
+  // Removes clues of a unique puzzle (or a full grid) one by one in random order, keeping each whose removal would
+  // admit a second solution; one pass leaves a minimal puzzle
+  Cells minimize(const Cells& cells);
+
+  // True when the puzzle is unique and every clue is needed
+  bool minimal(const Cells& cells);
+
+private:
+
+  Cells grid{};
+  std::array<uint16_t, 9> rows{}, cols{}, boxes{};
+  std::array<uint16_t, 81> banned{}; // digits a cell may not take, on top of the unit masks
+  std::array<uint8_t, 81> trail{}; // placements in order, so a failed branch unwinds to a mark
+  size_t depth = 0;
+
+  bool load(const Cells& cells);
+  bool search();
+  size_t countFrom(size_t limit);
+  bool needed(size_t pos);
+  bool propagate();
+
+  void place(size_t pos, uint8_t val);
+  void undo(size_t mark);
+  uint16_t candidates(size_t pos) const;
+};
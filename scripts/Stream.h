@@ -0,0 +1,246 @@
+#pragma once
+
+#include "Sudoku.h"
+#include "Random.h"
+#include "Canon.h"
+#include "Isomorph.h"
+#include "Format.h"
+#include "Writer.h"
+#include "Placement.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Lazy grid pipelines. A source makes one grid at a time and pushes it through stages joined with |, so no stage
+// collects anything and a grid travels by reference from source to sink before the next one is made:
+//
+//   (Stream::grids(n, true) | Stream::distinct() | Stream::isomorphs(4) | Stream::write(writer)).run(threads);
+//
+// A stage is any callable (Sudoku& grid, const Stream::Context& at, auto&& next) -> bool that forwards grids by
+// calling next(grid): the one it was handed, the same one changed, none, or several new ones. Returning false ends
+// the stream; a stage that never calls next is a sink. run(threads) splits the source by index over threads that
+// share the stage objects, so stateful stages synchronise, as the ones here do. Grids reach the sink in whatever
+// order the threads finish them, unless run is asked to keep source order.
+class Stream {
+
+public:
+
+  struct Context {
+    size_t index;  // source position of the grid being pushed
+    size_t worker; // thread running it, 0 .. threads - 1
+    bool ordered;  // pushes arrive one at a time in source order (run with inOrder)
+  };
+
+  template <class Source, class... Stages> class Pipeline;
+
+  // Generated grids; grid i comes from the Philox stream (seed, i) when seeded, so output doesn't depend on threads
+  struct Grids {
+    size_t count;
+    bool band, assured, seeded;
+    uint64_t seed;
+
+    size_t size() const { return count; }
+
+    void make(Sudoku& g, size_t i) const {
+      if (seeded) reseedThread(seed, i);
+      do { if (band) g.band_generate(); else g.root_generate(true, g.getBox(i % 9), 8 - (i % 9)); } while (assured && !g.validateGrid());
+    }
+  };
+
+  // Any indexed producer, make(Sudoku&, index)
+  template <class Make>
+  struct Generated {
+    size_t count;
+    Make fn;
+
+    size_t size() const { return count; }
+    void make(Sudoku& g, size_t i) const { fn(g, i); }
+  };
+
+  static Pipeline<Grids> grids(size_t count, bool band = false, bool assured = true);
+  static Pipeline<Grids> grids(size_t count, bool band, bool assured, uint64_t seed);
+
+  template <class Make>
+  static Pipeline<Generated<Make>> source(size_t count, Make make);
+
+  /* --- Stages --- */
+
+  static auto valid() {
+    return [](Sudoku& g, const Context&, auto&& next) { return !g.validateGrid() || next(g); };
+  }
+
+  template <class Pred>
+  static auto filter(Pred pred) {
+    return [pred](Sudoku& g, const Context&, auto&& next) { return !pred(static_cast<const Sudoku&>(g)) || next(g); };
+  }
+
+  // fn(Sudoku&) edits the grid in place, e.g. a transform
+  template <class Fn>
+  static auto transform(Fn fn) {
+    return [fn](Sudoku& g, const Context&, auto&& next) { fn(g); return next(g); };
+  }
+
+  // fn(const Sudoku&, emit) calls emit(Sudoku&) for every grid it derives; emit returns false once the stream ends
+  template <class Fn>
+  static auto expand(Fn fn) {
+    return [fn](Sudoku& g, const Context&, auto&& next) {
+      bool go = true;
+      fn(static_cast<const Sudoku&>(g), [&](Sudoku& derived) { return go = go && next(derived); });
+      return go;
+    };
+  }
+
+  // Replaces every grid with a uniformly random equivalent one (Sudoku::randomizeEquivalent)
+  static auto scramble() {
+    return [](Sudoku& g, const Context&, auto&& next) { g.randomizeEquivalent(); return next(g); };
+  }
+
+  // The grid itself (unless keep is false), then up to n distinct images under random symmetries
+  static auto isomorphs(size_t n, bool keep = true) {
+    return [n, keep](Sudoku& g, const Context&, auto&& next) {
+      if (keep && !next(g)) return false;
+
+      bool go = true;
+      Sudoku image;
+      expandIsomorphs(g, n, [&](const Sudoku& s, uint64_t) { if (go) { image = s; go = next(image); } });
+      return go;
+    };
+  }
+
+  // Drops grids whose minlex form was already seen, so only essentially different grids pass
+  static auto distinct() {
+    struct Seen { std::mutex lock; std::unordered_set<std::string> forms; };
+    auto seen = std::make_shared<Seen>();
+
+    return [seen](Sudoku& g, const Context&, auto&& next) {
+      Canon::Cells form = Canon::minlex(g.getCells());
+      std::string key(form.begin(), form.end());
+      {
+        std::lock_guard<std::mutex> hold(seen->lock);
+        if (!seen->forms.insert(std::move(key)).second) return true;
+      }
+      return next(g);
+    };
+  }
+
+  // Forwards the first n grids to arrive, then ends the stream
+  static auto take(size_t n) {
+    auto taken = std::make_shared<std::atomic<size_t>>(0);
+
+    return [n, taken](Sudoku& g, const Context&, auto&& next) {
+      size_t k = (*taken)++;
+      return k < n && next(g) && k + 1 < n;
+    };
+  }
+
+  /* --- Sinks --- */
+
+  // fn(const Sudoku&, const Context&); called from every worker thread
+  template <class Fn>
+  static auto each(Fn fn) {
+    return [fn](Sudoku& g, const Context& at, auto&&) { fn(static_cast<const Sudoku&>(g), at); return true; };
+  }
+
+  // Hands grids to the writer lane of the running worker; the writer needs a lane per thread. An ordered run
+  // feeds lane 0 alone, so the file keeps source order. A failed write() ends the stream
+  static auto write(GridWriter& writer) {
+    return [&writer](Sudoku& g, const Context& at, auto&&) {
+      return writer.submit(at.ordered ? 0 : at.worker, g.getCells()) || !writer.failed();
+    };
+  }
+
+  static auto write(BlockWriter& writer, Format::Kind kind) {
+    auto lock = std::make_shared<std::mutex>();
+
+    return [&writer, kind, lock](Sudoku& g, const Context&, auto&&) {
+      std::lock_guard<std::mutex> hold(*lock);
+      writer.grid(kind, g.getCells());
+      return !writer.error();
+    };
+  }
+};
+
+template <class Source, class... Stages>
+class Stream::Pipeline {
+
+public:
+
+  Pipeline(Source source, std::tuple<Stages...> stages) : source(std::move(source)), stages(std::move(stages)) {}
+
+  template <class Stage>
+  Pipeline<Source, Stages..., std::decay_t<Stage>> operator|(Stage&& stage) && {
+    return { std::move(source), std::tuple_cat(std::move(stages), std::make_tuple(std::forward<Stage>(stage))) };
+  }
+
+  // Pushes every source grid through the stages until the source runs out or a stage ends the stream;
+  // returns how many grids the source made. Worker w pins itself as placement worker w before its first grid; with
+  // a pinning placement every worker gets its own thread, so the caller's affinity is left as it was.
+  // With inOrder the workers still make grids in parallel, but grid i enters the stages only after grid i - 1 has
+  // left them, so the sink sees exactly the sequence a one-thread run gives.
+  size_t run(size_t threads = 1, const Placement& placement = Placement(), bool inOrder = false) {
+    std::atomic<size_t> next{ 0 }, made{ 0 }, turn{ 0 };
+    std::atomic<bool> stopped{ false };
+
+    auto worker = [&](size_t w) {
+      placement.pin(w);
+      Sudoku g;
+      size_t local = 0;
+
+      for (size_t i = next++; i < source.size() && !stopped.load(std::memory_order_relaxed); i = next++) {
+        source.make(g, i);
+        local++;
+
+        if (inOrder) {
+          while (turn.load(std::memory_order_acquire) != i && !stopped.load(std::memory_order_relaxed)) std::this_thread::yield();
+          if (stopped.load(std::memory_order_relaxed)) break;
+        }
+        if (!push<0>(g, Context{ i, w, inOrder })) stopped.store(true, std::memory_order_relaxed);
+        if (inOrder) turn.store(i + 1, std::memory_order_release);
+      }
+      made += local;
+    };
+
+    std::vector<std::thread> pool;
+    size_t first = placement.pins() ? 0 : 1;
+    for (size_t w = first; w < std::max<size_t>(threads, 1); w++) pool.emplace_back(worker, w);
+    if (first) worker(0);
+    for (auto& t : pool) t.join();
+
+    return made;
+  }
+
+private:
+
+  Source source;
+  std::tuple<Stages...> stages;
+
+  template <size_t I>
+  bool push(Sudoku& g, const Context& at) {
+    if constexpr (I == sizeof...(Stages)) return true;
+    else return std::get<I>(stages)(g, at, [this, &at](Sudoku& h) { return push<I + 1>(h, at); });
+  }
+};
+
+inline Stream::Pipeline<Stream::Grids> Stream::grids(size_t count, bool band, bool assured) {
+  return { Grids{ count, band, assured, false, 0 }, {} };
+}
+
+inline Stream::Pipeline<Stream::Grids> Stream::grids(size_t count, bool band, bool assured, uint64_t seed) {
+  return { Grids{ count, band, assured, true, seed }, {} };
+}
+
+template <class Make>
+Stream::Pipeline<Stream::Generated<Make>> Stream::source(size_t count, Make make) {
+  return { Generated<Make>{ count, std::move(make) }, {} };
+}
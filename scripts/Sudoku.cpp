@@ -1,4 +1,10 @@
 #include "Sudoku.h"
+#include "Symmetry.h"
+#include "BandTable.h"
+#include "Random.h"
+#include "Solver.h"
+#include "Format.h"
+#include "Perf.h"
 
 #include <iostream>
 #include <unordered_map>
@@ -8,18 +14,62 @@
 #include <numeric>
 #include <random>
 #include <cassert>
+#include <bitset>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <optional>
 
-static thread_local std::mt19937 rng {
+static thread_local Philox rng {
 		[] {
 				std::random_device rd;
-				std::array<std::uint32_t, 624> seed_data{};
-				for (auto& s : seed_data) s = rd();
-				std::seed_seq seq(seed_data.begin(), seed_data.end());
-				return std::mt19937(seq);
+				uint64_t seed = (uint64_t(rd()) << 32) | rd(), stream = (uint64_t(rd()) << 32) | rd();
+				return Philox(seed, stream);
 		} ()
 };
 
-Sudoku::Sudoku() { flattenGrid(); }
+Philox& threadRng() { return rng; }
+
+void reseedThread(uint64_t seed, uint64_t index) { rng.reseed(seed, index); }
+
+static constexpr uint16_t allDigits = 0x3FE; // bits 1..9
+
+// Box and cell offsets of every row-major grid position, resolved at compile time
+struct Slot { uint8_t box, cell; };
+
+static constexpr std::array<Slot, 81> cellSlots = [] {
+	std::array<Slot, 81> slots{};
+	for (size_t r = 0; r < 9; r++) {
+		for (size_t c = 0; c < 9; c++) {
+			slots[9 * r + c] = { uint8_t(3 * (r / 3) + c / 3), uint8_t(3 * (r % 3) + c % 3) };
+		}
+	}
+	return slots;
+} ();
+
+// Row-major grid position of every box cell, the inverse of cellSlots
+static constexpr std::array<uint8_t, 81> boxCellPos = [] {
+	std::array<uint8_t, 81> pos{};
+	for (size_t i = 0; i < 81; i++) pos[9 * cellSlots[i].box + cellSlots[i].cell] = uint8_t(i);
+	return pos;
+} ();
+
+// Zobrist keys per position and digit; blanks hash to zero so partial grids fingerprint too
+static constexpr std::array<std::array<uint64_t, 10>, 81> zobrist = [] {
+	std::array<std::array<uint64_t, 10>, 81> keys{};
+	uint64_t state = 0x5375646F6B75ULL;
+	for (auto& pos : keys) {
+		for (size_t d = 1; d < 10; d++) {
+			uint64_t z = (state += 0x9E3779B97F4A7C15ULL); // splitmix64
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			pos[d] = z ^ (z >> 31);
+		}
+	}
+	return keys;
+} ();
+
+Sudoku::Sudoku() {}
 
 uint8_t* Sudoku::Box::findRowNull(size_t pos) {// Find first empty position in a Box's row
 	for (size_t c = 0; c < 3; c++) {
@@ -52,243 +102,191 @@ bool Sudoku::Box::find(uint8_t val) {// Check existence of val in a relevant Box
 }
 
 const bool Sudoku::Box::findRowVal(size_t pos, uint8_t val) {// Check existence of val in a Box's row
-	for (std::reference_wrapper<uint8_t> ref : row(pos)) {
-		if (ref.get() == val) return true;
+	for (uint8_t cell : row(pos)) {
+		if (cell == val) return true;
 	}
 
 	return false;
 }
 
 const bool Sudoku::Box::findColVal(size_t pos, uint8_t val) {// Check existence of val in a Box's column
-	for (std::reference_wrapper<uint8_t> ref : col(pos)) {
-		if (ref.get() == val) return true;
+	for (uint8_t cell : col(pos)) {
+		if (cell == val) return true;
 	}
 
 	return false;
 }
 
 Sudoku::Box& Sudoku::getBox(size_t pos) {// Grab a box from the boxes array using the overload
-	if (pos > 8) {
-		throw std::out_of_range("");
-	}
+	bounds_check(pos > 8, "Box index out of range")
 
-	size_t _band = pos / 3;
-	size_t _stack = pos % 3;
-	return getBox(_band, _stack);
+	return getBox(pos / 3, pos % 3);
 }
 
 Sudoku::Box& Sudoku::getBox(size_t _band, size_t _stack) {// Grab a box from the boxes array
-	if (_band > 2 || _stack > 2) {
-		throw std::out_of_range("");
-	}
+	bounds_check(_band > 2 || _stack > 2, "Band or stack index out of range")
 
-	size_t pos = 3 * _band + _stack;
-	boxes[pos].band = _band;
-	boxes[pos].stack = _stack;
-	return boxes[pos];
+	return boxes[3 * _band + _stack];
 }
 
 std::array<Sudoku::Box*, 3> Sudoku::getBand(size_t bandIdx) {// Extract an array of boxes to represent a band
-	if (bandIdx > 2) {
-		throw std::out_of_range("Band index out of range");
-	}
+	bounds_check(bandIdx > 2, "Band index out of range")
 
-	return { &boxes.at(bandIdx * 3 + 0),
-					 &boxes.at(bandIdx * 3 + 1),
-					 &boxes.at(bandIdx * 3 + 2)
-	};
+	return { &boxes[bandIdx * 3 + 0], &boxes[bandIdx * 3 + 1], &boxes[bandIdx * 3 + 2] };
 }
 
 std::array<Sudoku::Box*, 3> Sudoku::getStack(size_t stackIdx) {// Extract an array of boxes to represent a stack
-	if (stackIdx > 2) {
-		throw std::out_of_range("Stack index out of range");
-	}
+	bounds_check(stackIdx > 2, "Stack index out of range")
 
-	return { &boxes.at(0 + stackIdx),
-					 &boxes.at(3 + stackIdx),
-					 &boxes.at(6 + stackIdx)
-	};
+	return { &boxes[0 + stackIdx], &boxes[3 + stackIdx], &boxes[6 + stackIdx] };
 }
 
 std::array<uint8_t*, 9> Sudoku::getRow(size_t pos) {// Extract a row from the grid by position
-	if (pos > 8) {
-		throw std::out_of_range("Row index out of range");
-	}
-
-	size_t bandIndex = pos / 3; // which horizontal band (0-2)
-	size_t box_row = (pos % 3) * 3; // which row inside each box (0-2)
+	bounds_check(pos > 8, "Row index out of range")
 
-	std::array<uint8_t*, 9> row{ nullptr };
+	std::array<uint8_t*, 9> row;
 
-	std::array<Box*, 3> band = getBand(bandIndex);
-
-	size_t i = 0;
-
-	for (Box* box : band) {
-		size_t col_pos1 = box_row, col_pos2 = box_row + 1, col_pos3 = box_row + 2;
-		row[i] = &box->cells.at(col_pos1);
-		row[i + 1] = &box->cells.at(col_pos2);
-		row[i + 2] = &box->cells.at(col_pos3);
-		i += 3;
+	for (size_t i = 0; i < 9; i++) {
+		const Slot& slot = cellSlots[9 * pos + i];
+		row[i] = &boxes[slot.box].cells[slot.cell];
 	}
 
 	return row;
 }
 
 std::array<uint8_t*, 9> Sudoku::getRow(size_t bandIdx, size_t box_row) {// Band and row version of getRow
-	if (bandIdx > 2 || box_row > 2) {
-		throw std::out_of_range("Band or row index out of range");
-	}
-
-	std::array<uint8_t*, 9> row{ nullptr };
-
-	// Get the 3 boxes in this horizontal band
-	std::array<Box*, 3> band = getBand(bandIdx);
-
-	size_t i = 0;
-
-	for (Box* box : band) {
-		row[i] = &box->cells.at((box_row * 3) + 0);
-		row[i + 1] = &box->cells.at((box_row * 3) + 1);
-		row[i + 2] = &box->cells.at((box_row * 3) + 2);
-		i += 3;
-	}
+	bounds_check(bandIdx > 2 || box_row > 2, "Band or row index out of range")
 
-	return row;
+	return getRow(3 * bandIdx + box_row);
 }
 
 std::array<uint8_t*, 9> Sudoku::getCol(size_t pos) {// Extract the column from the grid by position
-	if (pos > 8) {
-		throw std::out_of_range("Row index out of range");
-	}
-
-	size_t stackIndex = pos / 3;   // which vertical stack (0–2)
-	size_t box_col = pos % 3;   // which column inside each box (0–2)
-
-	std::array<uint8_t*, 9> col{ nullptr };
+	bounds_check(pos > 8, "Col index out of range")
 
-	// Get the 3 boxes in this vertical stack
-	std::array<Box*, 3> stack = getStack(stackIndex);
+	std::array<uint8_t*, 9> col;
 
-	size_t i = 0;
-	for (Box* box : stack) {
-		col[i] = &box->cells.at(0 + box_col);
-		col[i + 1] = &box->cells.at(3 + box_col);
-		col[i + 2] = &box->cells.at(6 + box_col);
-		i += 3;
+	for (size_t i = 0; i < 9; i++) {
+		const Slot& slot = cellSlots[9 * i + pos];
+		col[i] = &boxes[slot.box].cells[slot.cell];
 	}
 
 	return col;
 }
 
-std::array<uint8_t*, 9> Sudoku::getCol(size_t stackIdx, size_t box_col) {// Stack and column version of getRow
-	if (stackIdx > 2 || box_col > 2) {
-		throw std::out_of_range("Stack or column index out of range");
-	}
-
-	std::array<uint8_t*, 9> col{ nullptr };
+std::array<uint8_t*, 9> Sudoku::getCol(size_t stackIdx, size_t box_col) {// Stack and column version of getCol
+	bounds_check(stackIdx > 2 || box_col > 2, "Stack or column index out of range")
 
-	// Get the 3 boxes in this vertical stack
-	std::array<Box*, 3> stack = getStack(stackIdx);
-
-	size_t i = 0;
-	for (Box* box : stack) {
-
-		// Assign cell references of box columns to full column
-		col[i] = &box->cells.at(0 + box_col);
-		col[i + 1] = &box->cells.at(3 + box_col);
-		col[i + 2] = &box->cells.at(6 + box_col);
-		i += 3;
-	}
-
-	return col;
+	return getCol(3 * stackIdx + box_col);
 }
 
 const bool Sudoku::findRowVal(size_t pos, uint8_t val) {// Check existence of val in the grid's row
-	if (pos > 8) {
-		throw std::out_of_range("Row index out of range");
-	}
+	bounds_check(pos > 8, "Row index out of range")
 
-	std::array<uint8_t*, 9> row = getRow(pos);
-
-	for (uint8_t* cell : row) {
-		if (*cell == val) return true;
+	for (size_t i = 0; i < 9; i++) {
+		const Slot& slot = cellSlots[9 * pos + i];
+		if (boxes[slot.box].cells[slot.cell] == val) return true;
 	}
 
 	return false;
 }
 
 const bool Sudoku::findColVal(size_t pos, uint8_t val) {// Check existence of val in the grid's column
-	if (pos > 8) {
-		throw std::out_of_range("Col index out of range");
-	}
-
-	std::array<uint8_t*, 9> col = getCol(pos);
+	bounds_check(pos > 8, "Col index out of range")
 
-	for (uint8_t* cell : col) {
-		if (*cell == val) return true;
+	for (size_t i = 0; i < 9; i++) {
+		const Slot& slot = cellSlots[9 * i + pos];
+		if (boxes[slot.box].cells[slot.cell] == val) return true;
 	}
 
 	return false;
 }
 
-void Sudoku::findAdjs(Sudoku::Box& rootBox, std::vector<Box*>& bAdjs, std::vector<Box*>& sAdjs) {
-	std::set<size_t> band_adj_pos(idxList.begin(), idxList.end());   // positions in stack (columns of boxes)
-	std::set<size_t> stack_adj_pos(idxList.begin(), idxList.end());  // positions in band (rows of boxes)
-	band_adj_pos.erase(rootBox.stack);
-	stack_adj_pos.erase(rootBox.band);
+// Everything Root_Propag derives from the root position: the adjacent and non-adjacent boxes in the order the
+// fill expects, and the Phistemofel ring and corner cells as offsets into the flat box-major grid
+struct RootLayout {
+	std::array<uint8_t, 2> bAdjs, sAdjs;
+	std::array<uint8_t, 4> nAdjs;
+	std::array<uint8_t, 16> ring, corners;
+};
 
-	// Find boxes adjacent to the root box
-	for (auto s : band_adj_pos) { bAdjs.push_back(&getBox(rootBox.band, s)); }
-	for (auto b : stack_adj_pos) { sAdjs.push_back(&getBox(b, rootBox.stack)); }
-}
+static constexpr std::array<RootLayout, 9> rootLayouts = [] {
+	std::array<RootLayout, 9> layouts{};
 
-void Sudoku::findNonAdjs(Sudoku::Box& rootBox, std::vector<Box*>& nAdjs) {
-	for (size_t b : idxList) {
-		for (size_t s : idxList) {
-			if (b != rootBox.band && s != rootBox.stack) {
-				nAdjs.push_back(&getBox(b, s));
+	for (size_t root = 0; root < 9; root++) {
+		RootLayout& l = layouts[root];
+		size_t band = root / 3, stack = root % 3, b = 0, s = 0, n = 0, r = 0, c = 0;
+
+		for (size_t i = 0; i < 3; i++) {
+			if (i != stack) l.bAdjs[b++] = uint8_t(3 * band + i);
+			if (i != band) l.sAdjs[s++] = uint8_t(3 * i + stack);
+		}
+
+		for (size_t box = 0; box < 9; box++) {
+			bool sameBand = box / 3 == band, sameStack = box % 3 == stack;
+			size_t base = 9 * box;
+
+			if (!sameBand && !sameStack) {
+				l.nAdjs[n++] = uint8_t(box);
+				l.ring[r++] = uint8_t(base + 4);
+				for (size_t corner : { 0, 2, 6, 8 }) l.corners[c++] = uint8_t(base + corner);
 			}
+			else if (sameBand && !sameStack) { for (size_t k = 0; k < 3; k++) l.ring[r++] = uint8_t(base + 3 * k + 1); } // middle column
+			else if (sameStack && !sameBand) { for (size_t k = 0; k < 3; k++) l.ring[r++] = uint8_t(base + 3 + k); } // middle row
 		}
 	}
+	return layouts;
+} ();
+
+void Sudoku::findAdjs(const Sudoku::Box& rootBox, Adjacent& bAdjs, Adjacent& sAdjs) {
+	const RootLayout& layout = rootLayouts[size_t(&rootBox - boxes.data())];
+
+	for (size_t i = 0; i < 2; i++) {
+		bAdjs[i] = &boxes[layout.bAdjs[i]];
+		sAdjs[i] = &boxes[layout.sAdjs[i]];
+	}
 }
 
-void Sudoku::NonAdjFill(std::vector<Box*> Non_Adjs, std::vector<Box*> B_Adjs, std::vector<Box*> S_Adjs, std::array<std::set<uint8_t>, 4> avails, std::array<std::vector<uint8_t>, 4> pools) {
-	size_t iter = 0, rnd = 0;
-	std::uniform_int_distribution<size_t> dist;
+void Sudoku::findNonAdjs(const Sudoku::Box& rootBox, NonAdjacent& nAdjs) {
+	const RootLayout& layout = rootLayouts[size_t(&rootBox - boxes.data())];
 
-	avails.fill(digits);
+	for (size_t i = 0; i < 4; i++) nAdjs[i] = &boxes[layout.nAdjs[i]];
+}
 
-	for (size_t i : idxList) {
-		std::array<std::reference_wrapper<uint8_t>, 3> b0_mcol = B_Adjs[0]->col(1);
-		std::array<std::reference_wrapper<uint8_t>, 3> b1_mcol = B_Adjs[1]->col(1);
-		std::array<std::reference_wrapper<uint8_t>, 3> s0_mrow = S_Adjs[0]->row(1);
-		std::array<std::reference_wrapper<uint8_t>, 3> s1_mrow = S_Adjs[1]->row(1);
+void Sudoku::NonAdjFill(const NonAdjacent& Non_Adjs, const Adjacent& B_Adjs, const Adjacent& S_Adjs, const Equiv_Map& ring, const Equiv_Map& assoc_map) {
+	Perf::Scope scope(Perf::NonAdjFill);
+	size_t iter = 0, rnd = 0;
+	std::uniform_int_distribution<size_t> dist;
 
-		uint8_t val;
+	// Non_Adjs is row-major over the two free bands and stacks, so box i shares its band with Non_Adjs[i ^ 1] and
+	// S_Adjs[i / 2], and its stack with Non_Adjs[i ^ 2] and B_Adjs[i % 2]
+	std::array<Box*, 4> bandMate, stackMate, bandAdj, stackAdj;
 
-		val = b0_mcol.at(i).get(); avails[0].erase(val);
-		val = b1_mcol.at(i).get(); avails[1].erase(val);
-		val = s0_mrow.at(i).get(); avails[2].erase(val);
-		val = s1_mrow.at(i).get(); avails[3].erase(val);
+	for (size_t i = 0; i < 4; i++) {
+		bandMate[i] = Non_Adjs[i ^ 1]; stackMate[i] = Non_Adjs[i ^ 2];
+		bandAdj[i] = S_Adjs[i / 2]; stackAdj[i] = B_Adjs[i % 2];
 	}
 
-	for (auto& pool : pools) {
-		pool.clear();
-	}
+	auto lineBits = [](const Box::Line& line) {
+		uint16_t bits = 0;
+		for (uint8_t val : line) bits |= uint16_t(1u << val);
+		return uint16_t(bits & allDigits);
+	};
 
-	for (auto val : avails[0]) {
-		if (avails[2].find(val) != avails[2].end()) pools[0].push_back(val);
-		if (avails[3].find(val) != avails[3].end()) pools[2].push_back(val);
-	}
+	// Digits of a mask in ascending order, as the std::set pools used to hold them
+	auto expand = [](uint16_t mask, uint8_t* out) {
+		size_t n = 0;
+		for (; mask; mask &= uint16_t(mask - 1)) out[n++] = uint8_t(__builtin_ctz(mask));
+		return n;
+	};
 
-	for (auto val : avails[1]) {
-		if (avails[2].find(val) != avails[2].end()) pools[1].push_back(val);
-		if (avails[3].find(val) != avails[3].end()) pools[3].push_back(val);
-	}
+	// A centre must avoid the middle column of its stack's adjacent box and the middle row of its band's
+	std::array<std::array<uint8_t, 9>, 4> pools;
+	std::array<size_t, 4> sizes;
 
-	for (auto& pool : pools) {
-		std::shuffle(pool.begin(), pool.end(), rng);
+	for (size_t i = 0; i < 4; i++) {
+		uint16_t free = uint16_t(allDigits & ~lineBits(stackAdj[i]->col(1)) & ~lineBits(bandAdj[i]->row(1)));
+		sizes[i] = expand(free, pools[i].data());
+		std::shuffle(pools[i].begin(), pools[i].begin() + sizes[i], rng);
 	}
 
 	iter = 0;
@@ -297,75 +295,50 @@ void Sudoku::NonAdjFill(std::vector<Box*> Non_Adjs, std::vector<Box*> B_Adjs, st
 
 		auto& pool = pools[iter];
 
-		dist = std::uniform_int_distribution<size_t>(0, size_t(pool.size() - 1));
+		dist = std::uniform_int_distribution<size_t>(0, size_t(sizes[iter] - 1));
 		uint8_t choice;
 
 		do { rnd = dist(rng); choice = pool[rnd]; } while (!choice);
 
 		if (iter == 0) {
-			for (auto& val : pools[1]) { if (val == choice) val = 0; }// pool nulling to prevent duplicates
-			for (auto& val : pools[2]) { if (val == choice) val = 0; }// pool nulling to prevent duplicates
+			for (size_t k = 0; k < sizes[1]; k++) { if (pools[1][k] == choice) pools[1][k] = 0; }// pool nulling to prevent duplicates
+			for (size_t k = 0; k < sizes[2]; k++) { if (pools[2][k] == choice) pools[2][k] = 0; }// pool nulling to prevent duplicates
 		}
 
 		else if ((iter == 1 || iter == 2)) {
-			for (auto& val : pools[3]) { if (val == choice) val = 0; }// pool nulling to prevent duplicates
+			for (size_t k = 0; k < sizes[3]; k++) { if (pools[3][k] == choice) pools[3][k] = 0; }// pool nulling to prevent duplicates
 		}
 
 		Non_Adjs[iter++]->cell(1, 1) = choice; //central cell placements
 
 	} while (iter <= 3);
 
-	std::unordered_map<size_t, int> freq;
+	// Phistemofel: the corner quads must hold exactly the ring's digits, so the ring counts drive the placement
+	std::array<uint8_t, 10> freq{}, ineligible{};
 
 	for (uint8_t* cell : ring) {
 		freq[*cell]++;  // increments count for this digit
 	}
 
-	std::vector<std::pair<size_t, int>> ordered_freq(freq.begin(), freq.end());
+	// Priority order as one packed key per ring digit: forced digits with two placements, then other forced digits,
+	// then by frequency and ineligible boxes (both descending), then by digit. At most nine keys, so an insertion pass
+	std::array<uint8_t, 9> ordered;
+	std::array<uint16_t, 9> keys;
+	size_t ringDigits = 0;
 
-	std::unordered_map<size_t, int> ineligibleBoxes;
-	for (auto& kv : ordered_freq) {
-		uint8_t digit = static_cast<uint8_t>(kv.first);
-		int _count = 0;
+	for (uint8_t digit = 1; digit <= 9; digit++) {
+		if (!freq[digit]) continue;
 
-		for (size_t i = 0; i < Non_Adjs.size(); ++i) {
-			if (Non_Adjs[i]->find(digit)) {
-				++_count;
-			}
-		}
-
-		ineligibleBoxes[digit] = _count;
-	}
+		for (Box* box : Non_Adjs) ineligible[digit] += box->find(digit);
 
-	std::sort(ordered_freq.begin(), ordered_freq.end(),
-		[&](const auto& a, const auto& b) {
-			size_t digitA = a.first, digitB = b.first;
-			int freqA = a.second, freqB = b.second;
-			int eligibleA = 4 - ineligibleBoxes[digitA];
-			int eligibleB = 4 - ineligibleBoxes[digitB];
+		bool forced = (freq[digit] == 4 - ineligible[digit]); // required placements == eligible slots
+		size_t rank = forced ? (freq[digit] == 2 ? 0 : 1) : 2;
+		uint16_t key = uint16_t((((rank * 17 + (16 - freq[digit])) * 5 + (4 - ineligible[digit])) << 4) | digit);
 
-			// Forced case: required placements == eligible slots
-			bool forcedA = (freqA == eligibleA);
-			bool forcedB = (freqB == eligibleB);
-
-			// Priority: forced with freq==2
-			if (forcedA && freqA == 2 && !(forcedB && freqB == 2)) return true;
-			if (forcedB && freqB == 2 && !(forcedA && freqA == 2)) return false;
-
-			// Forced digits first
-			if (forcedA != forcedB) return forcedA;
-
-			// Compare by frequency
-			if (freqA != freqB) return freqA > freqB;
-
-			// Tie-break: ineligible boxes
-			if (ineligibleBoxes[digitA] != ineligibleBoxes[digitB])
-				return ineligibleBoxes[digitA] > ineligibleBoxes[digitB];
-
-			// Final tie-break: digit ID
-			return digitA < digitB;
-		}
-	);
+		size_t k = ringDigits++;
+		for (; k > 0 && keys[k - 1] > key; k--) { keys[k] = keys[k - 1]; ordered[k] = ordered[k - 1]; }
+		keys[k] = key; ordered[k] = digit;
+	}
 
 	std::array<std::array<uint8_t*, 4>, 4> quads{ nullptr };
 	for (auto& quad : quads) quad.fill(nullptr);
@@ -374,9 +347,15 @@ void Sudoku::NonAdjFill(std::vector<Box*> Non_Adjs, std::vector<Box*> B_Adjs, st
 		iter = i / 4;
 		size_t index = i % 4;
 
-		quads.at(iter).at(index) = assoc_map.at(i);
+		quads[iter][index] = assoc_map[i];
 	}
 
+	// The lines left open once the corners are in: rows 0 and 2 of both free bands, columns 0 and 2 of both free stacks
+	std::array<std::array<uint8_t*, 9>, 4> rows{ getRow(bandOf(*Non_Adjs[0]), 0), getRow(bandOf(*Non_Adjs[0]), 2),
+	                                             getRow(bandOf(*Non_Adjs[2]), 0), getRow(bandOf(*Non_Adjs[2]), 2) };
+	std::array<std::array<uint8_t*, 9>, 4> cols{ getCol(stackOf(*Non_Adjs[0]), 0), getCol(stackOf(*Non_Adjs[0]), 2),
+	                                             getCol(stackOf(*Non_Adjs[1]), 0), getCol(stackOf(*Non_Adjs[1]), 2) };
+
 	bool check = false;
 	int tries = 0;
 	int max = 100;
@@ -389,114 +368,65 @@ void Sudoku::NonAdjFill(std::vector<Box*> Non_Adjs, std::vector<Box*> B_Adjs, st
 		do {
 			if (corner_tries >= corner_max) break;
 
-			std::vector<size_t> boxCandidates;
-			std::vector<size_t> cellCandidates;
-			freq.clear();
-
-			for (auto& kv : ordered_freq) {
-				int requiredPlacements = kv.second;
+			for (size_t o = 0; o < ringDigits; o++) {
+				uint8_t digit = ordered[o];
+				int requiredPlacements = freq[digit];
 				int placed = 0;
 
-				uint8_t digit = static_cast<uint8_t>(kv.first);
-				for (size_t b = 0; b < Non_Adjs.size(); b++) {
-					check = !Non_Adjs[b]->find(digit);
-					if (check) boxCandidates.push_back(b);
-				}
-
-				std::shuffle(boxCandidates.begin(), boxCandidates.end(), rng);
-
-				auto computeCheck = [&](size_t idx, Box* N_B_Adj, Box* N_S_Adj) -> bool {
-					bool result;
-					size_t oppPos;
+				std::array<size_t, 4> boxCandidates;
+				size_t boxCount = 0;
 
-					if (idx % 2 == 0) {
-						oppPos = static_cast<size_t>((!idx) ? idx + 2 : idx - 2);
-						result = (N_S_Adj->findColVal(1, digit) || Non_Adjs[oppPos]->findColVal(1, digit));
-						oppPos = static_cast<size_t>(idx + 1);
-						result = result && (N_B_Adj->findRowVal(1, digit) || Non_Adjs[oppPos]->findRowVal(1, digit));
-					}
-					else {
-						oppPos = static_cast<size_t>((idx < 2) ? idx + 2 : idx - 2);
-						result = (N_S_Adj->findColVal(1, digit) || Non_Adjs[oppPos]->findColVal(1, digit));
-						oppPos = static_cast<size_t>(idx - 1);
-						result = result && (N_B_Adj->findRowVal(1, digit) || Non_Adjs[oppPos]->findRowVal(1, digit));
-					}
+				for (size_t b = 0; b < 4; b++) {
+					if (!Non_Adjs[b]->find(digit)) boxCandidates[boxCount++] = b;
+				}
 
-					return result;
-				};
+				std::shuffle(boxCandidates.begin(), boxCandidates.begin() + boxCount, rng);
 
-				std::stable_sort(boxCandidates.begin(), boxCandidates.end(),
-					[&](const auto& a, const auto& b) {
-						// find adjacents for a and b
-						Box* N_B_Adj1 = nullptr, * N_S_Adj1 = nullptr;
-						Box* N_B_Adj2 = nullptr, * N_S_Adj2 = nullptr;
+				// Boxes whose middle row and column are both already covered for digit go first, in shuffled order
+				std::array<size_t, 4> preferred, rest;
+				size_t preferredCount = 0, restCount = 0;
 
-						for (Box* S_Adj : S_Adjs) {
-							if (S_Adj->band == Non_Adjs[a]->band) N_B_Adj1 = S_Adj;
-							if (S_Adj->band == Non_Adjs[b]->band) N_B_Adj2 = S_Adj;
-						}
-						for (Box* B_Adj : B_Adjs) {
-							if (B_Adj->stack == Non_Adjs[a]->stack) N_S_Adj1 = B_Adj;
-							if (B_Adj->stack == Non_Adjs[b]->stack) N_S_Adj2 = B_Adj;
-						}
+				for (size_t k = 0; k < boxCount; k++) {
+					size_t b = boxCandidates[k];
+					bool covered = (stackAdj[b]->findColVal(1, digit) || stackMate[b]->findColVal(1, digit))
+						&& (bandAdj[b]->findRowVal(1, digit) || bandMate[b]->findRowVal(1, digit));
 
-						bool checkA = computeCheck(a, N_B_Adj1, N_S_Adj1);
-						bool checkB = computeCheck(b, N_B_Adj2, N_S_Adj2);
+					if (covered) preferred[preferredCount++] = b; else rest[restCount++] = b;
+				}
 
-						if (checkA != checkB) return checkA; // true if A should precede B
-						return false; // treat as equivalent
-					}
-				);
+				for (size_t k = 0; k < restCount; k++) preferred[preferredCount + k] = rest[k];
 
-				auto cellAllowsDigit = [&](size_t boxPos, size_t cellPos, uint8_t digit) {
+				auto cellAllowsDigit = [&](size_t boxPos, size_t cellPos) {
 					if (*quads[boxPos][cellPos] != 0) return false;
 
-					bool check1, check2;
-					Box* B_Adj, * S_Adj, * Non_Adj1, * Non_Adj2;
-
-					if (boxPos % 2 == 0) { B_Adj = B_Adjs[0]; Non_Adj1 = (!boxPos) ? Non_Adjs[1] : Non_Adjs[3]; }
-					else { B_Adj = B_Adjs[1]; Non_Adj1 = (boxPos < 2) ? Non_Adjs[0] : Non_Adjs[2]; }
-
-					if (boxPos >= 2) { S_Adj = S_Adjs[1]; Non_Adj2 = (boxPos == 2) ? Non_Adjs[0] : Non_Adjs[1]; }
-					else { S_Adj = S_Adjs[0]; Non_Adj2 = (!boxPos) ? Non_Adjs[2] : Non_Adjs[3]; }
-
-					check1 = (cellPos < 2);
-					check2 = (cellPos % 2 == 0);
-
+					bool top = (cellPos < 2), left = (cellPos % 2 == 0);
 
-					// --- Column elims --- 
-					if (S_Adj->findRowVal(check1 ? 0 : 2, digit) ||
-						Non_Adj1->findRowVal(check1 ? 0 : 2, digit)) {
-						return false;
-					}
+					// --- Row elims ---
+					if (bandAdj[boxPos]->findRowVal(top ? 0 : 2, digit) || bandMate[boxPos]->findRowVal(top ? 0 : 2, digit)) return false;
 
-					// --- Row elims --- 
-					if (B_Adj->findColVal(check2 ? 0 : 2, digit) ||
-						Non_Adj2->findColVal(check2 ? 0 : 2, digit)) {
-						return false;
-					}
+					// --- Column elims ---
+					if (stackAdj[boxPos]->findColVal(left ? 0 : 2, digit) || stackMate[boxPos]->findColVal(left ? 0 : 2, digit)) return false;
 
 					return true;
 				};
 
-				for (size_t i = 0; i < boxCandidates.size(); i++) {
-					size_t chosenBox = boxCandidates[i];
+				for (size_t i = 0; i < boxCount; i++) {
+					size_t chosenBox = preferred[i];
+					std::array<size_t, 4> cellCandidates;
+					size_t cellCount = 0;
 
 					for (size_t c = 0; c < 4; c++) {
-						if (cellAllowsDigit(chosenBox, c, digit)) cellCandidates.push_back(c);
+						if (cellAllowsDigit(chosenBox, c)) cellCandidates[cellCount++] = c;
 					}
 
-					if (cellCandidates.empty()) continue;
+					if (!cellCount) continue;
 
-					if (cellCandidates.size() > 1) std::shuffle(cellCandidates.begin(), cellCandidates.end(), rng);
-					size_t chosenCell = cellCandidates.front();
-					cellCandidates.clear();
+					if (cellCount > 1) std::shuffle(cellCandidates.begin(), cellCandidates.begin() + cellCount, rng);
 
-					*quads[chosenBox][chosenCell] = digit;
+					*quads[chosenBox][cellCandidates[0]] = digit;
 					placed++;
 				}
 
-				boxCandidates.clear();
 				if (placed != requiredPlacements) break;
 			}
 
@@ -508,73 +438,44 @@ void Sudoku::NonAdjFill(std::vector<Box*> Non_Adjs, std::vector<Box*> B_Adjs, st
 				}
 				};
 
-			for (auto& cell : assoc_map) {
-				if (!*cell) { check = false; corner_tries++; reset(); break; }
-			}
-
-			if (!check) continue;
+			std::array<uint8_t, 10> corners{};
 
 			for (uint8_t* cell : assoc_map) {
-				freq[*cell]++;  // increments count for this digit
+				if (!*cell) { check = false; break; }
+				corners[*cell]++;
 			}
 
-			for (auto& kv : ordered_freq) {
-				size_t digit = kv.first;
-				int expected = kv.second;
-				int actual = freq[digit];  // defaults to 0 if missing
-
-				if (actual != expected) {
-					check = false;
-					corner_tries++;
-					reset();
-
-					break;
+			if (check) {
+				for (size_t o = 0; o < ringDigits; o++) {
+					if (corners[ordered[o]] != freq[ordered[o]]) { check = false; break; }
 				}
 			}
 
+			if (!check) { corner_tries++; reset(); }
+
 		} while (!check);
 
 		check = true;
 
 		/* --- Final placements for sudoku grid --- */
 
-		std::vector<std::array<uint8_t*, 9>> rows{};
-		std::vector<std::array<uint8_t*, 9>> cols{};
-		std::vector<uint8_t*> placed{};
-		avails.fill(digits);
-
-		for (size_t i = 0; i < 3; i++) {
-			if (!i) {
-				rows.push_back(getRow(Non_Adjs[i]->band, 0));
-				rows.push_back(getRow(Non_Adjs[i]->band, 2));
+		std::array<uint8_t*, 16> placed;
+		size_t placedCount = 0;
 
-				cols.push_back(getCol(Non_Adjs[i]->stack, 0));
-				cols.push_back(getCol(Non_Adjs[i]->stack, 2));
-			}
-
-			if (i == 1) {
-				cols.push_back(getCol(Non_Adjs[i]->stack, 0));
-				cols.push_back(getCol(Non_Adjs[i]->stack, 2));
-			}
-
-			if (i == 2) {
-				rows.push_back(getRow(Non_Adjs[i]->band, 0));
-				rows.push_back(getRow(Non_Adjs[i]->band, 2));
-			}
-		}
-
-		auto propagate = [&](auto& line, auto& pool, bool type, auto pickAdjacents) -> bool {
+		auto propagate = [&](auto& line, bool type, Box* NA1, Box* NA2) -> bool {
 			// Find first two empty positions
 			size_t emptyIdx[2] = { 9, 9 };
-			for (size_t j = 0, k = 0; j < line.size() && k < 2; ++j) {
-				if (!*line[j]) emptyIdx[k++] = j;
-			}
-			if (emptyIdx[0] == 9 || emptyIdx[1] == 9) return false;
+			uint16_t missing = allDigits;
 
-			uint8_t cand1 = pool[0];
-			uint8_t cand2 = pool[1];
+			for (size_t j = 0, k = 0; j < line.size(); ++j) {
+				if (!*line[j]) { if (k < 2) emptyIdx[k++] = j; }
+				else missing &= uint16_t(~(1u << *line[j]));
+			}
+			if (emptyIdx[0] == 9 || emptyIdx[1] == 9 || !missing || !(missing & (missing - 1))) return false;
 
-			auto [NA1, NA2] = pickAdjacents();
+			// The two smallest digits the line is missing
+			uint8_t cand1 = uint8_t(__builtin_ctz(missing));
+			uint8_t cand2 = uint8_t(__builtin_ctz(missing & (missing - 1)));
 
 			auto place = [&]() -> bool {
 
@@ -599,8 +500,8 @@ void Sudoku::NonAdjFill(std::vector<Box*> Non_Adjs, std::vector<Box*> B_Adjs, st
 				EC[1][1] = crossCheck(emptyIdx[1], cand2);
 
 				auto pushPlaced = [&](size_t idx1, size_t idx2) {
-					placed.push_back(line[emptyIdx[idx1]]);
-					placed.push_back(line[emptyIdx[idx2]]);
+					placed[placedCount++] = line[emptyIdx[idx1]];
+					placed[placedCount++] = line[emptyIdx[idx2]];
 					};
 
 				if ( (EC[0][0] && EC[0][1]) || (EC[1][0] && EC[1][1]) ) return false;
@@ -660,38 +561,18 @@ void Sudoku::NonAdjFill(std::vector<Box*> Non_Adjs, std::vector<Box*> B_Adjs, st
 				*cell = 0;
 			}
 
-			for (auto& cell : placed) {
-				*cell = 0;
+			for (size_t k = 0; k < placedCount; k++) {
+				*placed[k] = 0;
 			}
 		};
 
 		// --- Propagation for rows ---
 		for (size_t i = 0; i < rows.size(); i++) {
-			for (uint8_t* cell : rows[i]) {
-				if (*cell) avails[i].erase(*cell);
-			}
-
-			pools[i].assign(avails[i].begin(), avails[i].end());
-			check = propagate(rows[i], pools[i], 1, [&]() {
-				return (i < 2)
-					? std::pair<Box*, Box*>{ Non_Adjs[0], Non_Adjs[1] }
-				: std::pair<Box*, Box*>{ Non_Adjs[2], Non_Adjs[3] };
-				});
+			check = (i < 2) ? propagate(rows[i], 1, Non_Adjs[0], Non_Adjs[1]) : propagate(rows[i], 1, Non_Adjs[2], Non_Adjs[3]);
 
 			if (!check) { reset(); tries++; break; }
 
-			avails[i] = digits;
-
-			for (uint8_t* cell : cols[i]) {
-				if (*cell) avails[i].erase(*cell);
-			}
-
-			pools[i].assign(avails[i].begin(), avails[i].end());
-			check = propagate(cols[i], pools[i], 0, [&]() {
-				return (i < 2)
-					? std::pair<Box*, Box*>{ Non_Adjs[0], Non_Adjs[2] }
-				: std::pair<Box*, Box*>{ Non_Adjs[1], Non_Adjs[3] };
-				});
+			check = (i < 2) ? propagate(cols[i], 0, Non_Adjs[0], Non_Adjs[2]) : propagate(cols[i], 0, Non_Adjs[1], Non_Adjs[3]);
 
 			if (!check) { reset(); tries++; break; }
 		}
@@ -699,46 +580,46 @@ void Sudoku::NonAdjFill(std::vector<Box*> Non_Adjs, std::vector<Box*> B_Adjs, st
 	} while (!check);
 }
 
-void Sudoku::Phistemofel(Box& rootBox) {// Assigns references of cell positions indicative of the Phistemofel ring
-	size_t inc1 = 0, inc2 = 0;
-
-	for (Box& box : boxes) {
-		if (box.band != rootBox.band && box.stack != rootBox.stack) {
-			ring.at(inc1++) = &box.cell(1, 1);
+void Sudoku::Phistemofel(const Box& rootBox, Equiv_Map& ring, Equiv_Map& assoc_map) {// Assigns references of cell positions indicative of the Phistemofel ring
+	Perf::Scope scope(Perf::Phistemofel);
+	const RootLayout& layout = rootLayouts[size_t(&rootBox - boxes.data())];
+	uint8_t* base = boxes[0].cells.data();
 
-			assoc_map.at(inc2++) = &box.cell(0, 0);
-			assoc_map.at(inc2++) = &box.cell(0, 2);
-			assoc_map.at(inc2++) = &box.cell(2, 0);
-			assoc_map.at(inc2++) = &box.cell(2, 2);
-
-		} else {
-			if ((box.band == rootBox.band) != (box.stack == rootBox.stack)) {
-				if (box.band == rootBox.band) {
-					for (std::reference_wrapper<uint8_t> ref : box.col(1)) {
-						ring.at(inc1++) = &ref.get();
-					}
-				} else {
-					for (std::reference_wrapper<uint8_t> ref : box.row(1)) {
-						ring.at(inc1++) = &ref.get();
-					}
-				}
-			}
-		}
+	for (size_t i = 0; i < 16; i++) {
+		ring[i] = base + layout.ring[i];
+		assoc_map[i] = base + layout.corners[i];
 	}
 }
 
 void Sudoku::Root_Propag(Box& rootBox, bool empty) {// Propagation algorithm for grid construction at any position
+	static constexpr std::array<void (Sudoku::*)(bool), 9> specialized = {
+		&Sudoku::rootPropag<0>, &Sudoku::rootPropag<1>, &Sudoku::rootPropag<2>,
+		&Sudoku::rootPropag<3>, &Sudoku::rootPropag<4>, &Sudoku::rootPropag<5>,
+		&Sudoku::rootPropag<6>, &Sudoku::rootPropag<7>, &Sudoku::rootPropag<8>
+	};
+
+	size_t root = size_t(&rootBox - boxes.data());
+	bounds_check(root > 8, "Root box must belong to this grid")
+	(this->*specialized[root])(empty);
+}
+
+template <size_t Root>
+void Sudoku::rootPropag(bool empty) {
+	static constexpr RootLayout layout = rootLayouts[Root];
+
+	Box& rootBox = boxes[Root];
 	std::array<size_t, 3> locIdxList = idxList; // Working copy of idxList to keep idxList static and shuffle the copy
 	size_t rnd;
 
 	std::array<std::set<uint8_t>, 4> avails; avails.fill(digits);
 	std::array<std::vector<uint8_t>, 4> pools;
 
-	std::vector<Box*> B_Adjs, S_Adjs, N_Adjs;
-	findAdjs(rootBox, B_Adjs, S_Adjs);
+	Adjacent B_Adjs{ &boxes[layout.bAdjs[0]], &boxes[layout.bAdjs[1]] }, S_Adjs{ &boxes[layout.sAdjs[0]], &boxes[layout.sAdjs[1]] };
 
+	std::optional<Perf::Scope> stage; // each emplace closes the previous stage's counters
 
 	/* --- Stage 1: Fill root box --- */
+	stage.emplace(Perf::RootFill);
 	pools[0].assign(avails[0].begin(), avails[0].end());
 
 	std::shuffle(pools[0].begin(), pools[0].end(), rng);
@@ -750,13 +631,15 @@ void Sudoku::Root_Propag(Box& rootBox, bool empty) {// Propagation algorithm for
 			std::shuffle(locIdxList.begin(), locIdxList.end(), rng);
 
 			for (size_t c : locIdxList) {
-				rootBox.cell(r, c) = pools[0].at(iter++);
+				rootBox.cell(r, c) = pools[0][iter++];
 			}
 		}
 	}
 	/*--------------------------------------------------*/
 
 	/* --- Stage 2: Adjacent box fill --- */
+	stage.emplace(Perf::AdjacentFill);
+
 	for (size_t p : idxList) {
 		avails[0].erase(rootBox.cell(1, p));
 		avails[1].erase(rootBox.cell(p, 1));
@@ -776,8 +659,8 @@ void Sudoku::Root_Propag(Box& rootBox, bool empty) {// Propagation algorithm for
 		std::shuffle(locIdxList.begin(), locIdxList.end(), rng);
 
 		for (size_t p : locIdxList) {
-			B_Adjs[i]->cell(1, p) = pools[0].at(iter);
-			S_Adjs[i]->cell(p, 1) = pools[1].at(iter++);
+			B_Adjs[i]->cell(1, p) = pools[0][iter];
+			S_Adjs[i]->cell(p, 1) = pools[1][iter++];
 		}
 	}
 
@@ -786,11 +669,11 @@ void Sudoku::Root_Propag(Box& rootBox, bool empty) {// Propagation algorithm for
 	for (size_t p : idxList) {
 		for (size_t i = 0; i < 4; i++) {
 			if (i < 2) {
-				avails[i].erase(rootBox.row(1).at(p).get());
-				avails[i].erase(rootBox.row((i % 2 == 0) ? 0 : 2).at(p).get());
+				avails[i].erase(rootBox.row(1)[p]);
+				avails[i].erase(rootBox.row((i % 2 == 0) ? 0 : 2)[p]);
 			} else {
-				avails[i].erase(rootBox.col(1).at(p).get());
-				avails[i].erase(rootBox.col((i % 2 == 0) ? 0 : 2).at(p).get());
+				avails[i].erase(rootBox.col(1)[p]);
+				avails[i].erase(rootBox.col((i % 2 == 0) ? 0 : 2)[p]);
 			}
 		}
 	}
@@ -803,8 +686,13 @@ void Sudoku::Root_Propag(Box& rootBox, bool empty) {// Propagation algorithm for
 		std::shuffle(pool.begin(), pool.end(), rng);
 	}
 
-	std::array<std::reference_wrapper<uint8_t>, 3> rootMRow = rootBox.row(1);
-	std::array<std::reference_wrapper<uint8_t>, 3> rootMCol = rootBox.col(1);
+	// The root box is complete from here on, so its middle lines are shuffled as values
+	std::array<uint8_t, 3> rootMRow, rootMCol;
+
+	for (size_t p : idxList) {
+		rootMRow[p] = rootBox.row(1)[p];
+		rootMCol[p] = rootBox.col(1)[p];
+	}
 
 	std::shuffle(rootMRow.begin(), rootMRow.end(), rng);
 	std::shuffle(rootMCol.begin(), rootMCol.end(), rng);
@@ -818,7 +706,7 @@ void Sudoku::Root_Propag(Box& rootBox, bool empty) {// Propagation algorithm for
 	std::uniform_int_distribution<size_t> dist(0, 1);
 
 	// Lambda function for handling adjacent box completions
-	auto adjFill = [&](std::vector<Box*> Adjs, size_t i, bool side) {
+	auto adjFill = [&](const Adjacent& Adjs, size_t i, bool side) {
 		rnd = dist(rng);
 
 		for (size_t i : idxList) {
@@ -828,40 +716,37 @@ void Sudoku::Root_Propag(Box& rootBox, bool empty) {// Propagation algorithm for
 			uint8_t& cellRef3 = Adjs[other]->cell(!(side) ? offMidPos[0] : locIdxList[i], !(side) ? locIdxList[i] : offMidPos[0]);
 			uint8_t& cellRef4 = Adjs[other]->cell(!(side) ? offMidPos[1] : _locIdxList[i], !(side) ? _locIdxList[i] : offMidPos[1]);
 
-			for (std::reference_wrapper<uint8_t> ref : !(side) ? Adjs[rnd]->row(1) : Adjs[rnd]->col(1)) {
-				if (pools[!(side) ? 0 : 2][i] == ref.get()) { cellRef3 = pools[!(side) ? 0 : 2][i]; }
-				if (pools[!(side) ? 1 : 3][i] == ref.get()) { cellRef4 = pools[!(side) ? 1 : 3][i]; }
+			for (uint8_t ref : !(side) ? Adjs[rnd]->row(1) : Adjs[rnd]->col(1)) {
+				if (pools[!(side) ? 0 : 2][i] == ref) { cellRef3 = pools[!(side) ? 0 : 2][i]; }
+				if (pools[!(side) ? 1 : 3][i] == ref) { cellRef4 = pools[!(side) ? 1 : 3][i]; }
 			}
 
-			for (std::reference_wrapper<uint8_t> ref : !(side) ? Adjs[other]->row(1) : Adjs[other]->col(1)) {
-				if (pools[!(side) ? 0 : 2][i] == ref.get()) { cellRef1 = pools[!(side) ? 0 : 2][i]; }
-				if (pools[!(side) ? 1 : 3][i] == ref.get()) { cellRef2 = pools[!(side) ? 1 : 3][i]; }
+			for (uint8_t ref : !(side) ? Adjs[other]->row(1) : Adjs[other]->col(1)) {
+				if (pools[!(side) ? 0 : 2][i] == ref) { cellRef1 = pools[!(side) ? 0 : 2][i]; }
+				if (pools[!(side) ? 1 : 3][i] == ref) { cellRef2 = pools[!(side) ? 1 : 3][i]; }
 			}
 		}
 
 		size_t _iter = 0;
 
 		do {
-			for (std::reference_wrapper<uint8_t> ref : !(side) ? Adjs[0]->row(0) : Adjs[0]->col(0)) {
-				uint8_t& cel = ref.get();
-
+			for (uint8_t& cel : !(side) ? Adjs[0]->row(0) : Adjs[0]->col(0)) {
 				if (!cel) {
-					cel = !(side) ? rootMRow.at(_iter).get() : rootMCol.at(_iter).get();
+					cel = !(side) ? rootMRow[_iter] : rootMCol[_iter];
 					uint8_t* cel2 = !(side) ? Adjs[1]->findRowNull(2) : Adjs[1]->findColNull(2);
 					if (cel2 != nullptr) {
-						*cel2 = !(side) ? rootMRow.at(_iter++).get() : rootMCol.at(_iter++).get();
+						*cel2 = !(side) ? rootMRow[_iter++] : rootMCol[_iter++];
 					}
 				}
 			}
 
 			if (iter < 3) {
-				for (std::reference_wrapper<uint8_t> ref : !(side) ? Adjs[1]->row(0) : Adjs[1]->col(0)) {
-					uint8_t& cel = ref.get();
+				for (uint8_t& cel : !(side) ? Adjs[1]->row(0) : Adjs[1]->col(0)) {
 					if (!cel) {
-						cel = !(side) ? rootMRow.at(_iter).get() : rootMCol.at(_iter).get();
+						cel = !(side) ? rootMRow[_iter] : rootMCol[_iter];
 						uint8_t* cel2 = !(side) ? Adjs[0]->findRowNull(2) : Adjs[0]->findColNull(2);
 						if (cel2 != nullptr) {
-							*cel2 = !(side) ? rootMRow.at(_iter++).get() : rootMCol.at(_iter++).get();
+							*cel2 = !(side) ? rootMRow[_iter++] : rootMCol[_iter++];
 						}
 					}
 				}
@@ -878,252 +763,237 @@ void Sudoku::Root_Propag(Box& rootBox, bool empty) {// Propagation algorithm for
 	/*--------------------------------------------------*/
 
 	/* --- Stage 3: Non-Adjacent box fills --- */
-	
-	findNonAdjs(rootBox, N_Adjs);
+	stage.emplace(Perf::NonAdjacentFill);
 
-	Phistemofel(rootBox);
-	NonAdjFill(N_Adjs, B_Adjs, S_Adjs, avails, pools);
+	NonAdjacent N_Adjs{ &boxes[layout.nAdjs[0]], &boxes[layout.nAdjs[1]], &boxes[layout.nAdjs[2]], &boxes[layout.nAdjs[3]] };
+
+	Equiv_Map ring, assoc_map;
+	Phistemofel(rootBox, ring, assoc_map);
+	NonAdjFill(N_Adjs, B_Adjs, S_Adjs, ring, assoc_map);
 
 	/*--------------------------------------------------*/
 }
 
-void Sudoku::Line_Propag(std::array<uint8_t, 9> row, std::array<uint8_t, 9> col) { /* --- Alternative propagation algorithm --- */
+void Sudoku::Line_Propag(const std::array<uint8_t, 9>& row, const std::array<uint8_t, 9>& col) { /* --- Alternative propagation algorithm --- */
 	std::array<std::set<uint8_t>, 4> avails;
 	std::array<std::vector<uint8_t>, 4> pools;
 
-	std::vector<Box*> B_Adjs, S_Adjs, N_Adjs;
+	Adjacent B_Adjs, S_Adjs;
+	NonAdjacent N_Adjs;
 
 	std::uniform_int_distribution<size_t> dist;
 	size_t rnd;
 
 	avails.fill(digits);
 
-	for (size_t i = 0; i < row.size(); i++) {
+	uint16_t rowBits = 0, colBits = 0;
+
+	for (size_t i = 0; i < 9; i++) {
 		if (!row[i] || !col[i]) return;
-		avails[0].erase(row[i]);
-		avails[1].erase(col[i]);
+		rowBits |= uint16_t(1u << row[i]);
+		colBits |= uint16_t(1u << col[i]);
 	}
-	
-	if (!(avails[0].empty() && avails[1].empty())) return;
+
+	if (rowBits != 0x3FE || colBits != 0x3FE) return;
+
+	const std::array<uint8_t, 9>* _row = &row;
+	const std::array<uint8_t, 9>* _col = &col;
+	std::array<uint8_t, 9> shuffled;
 
 	if (row == col) {
 		dist = std::uniform_int_distribution<size_t>(0, 1);
 		rnd = dist(rng);
-		
-		(rnd) ? std::shuffle(row.begin(), row.end(), rng) : std::shuffle(col.begin(), col.end(), rng); 
-	}
-
-	dist = std::uniform_int_distribution<size_t>(0, 8);
-	bool validIntersection = false;
-	size_t attempts = 0, MAXATTEMPTS = 20;
-
-	do {
-		if (attempts >= MAXATTEMPTS) return;
 
-		/* --- Initial placements by intersection logic --- */
-		rnd = dist(rng); // pick random index into row
+		shuffled = row;
+		std::shuffle(shuffled.begin(), shuffled.end(), rng);
+		(rnd) ? _row = &shuffled : _col = &shuffled;
+	}
 
-		uint8_t candidate = row[rnd]; // digit from row
+	/* --- Initial placements by intersection logic --- */
 
-		for (size_t i = 0; i < col.size(); i++) {
+	// Position of every digit in the column, so each row index maps straight to its intersection
+	std::array<size_t, 10> colPos{};
+	for (size_t j = 0; j < 9; j++) colPos[(*_col)[j]] = j;
 
-			if (col[i] == candidate) {
-				// Found intersection at (row[rnd], col[j])
+	auto sliceBits = [](const std::array<uint8_t, 9>& line, size_t pos) {
+		size_t start = (pos / 3) * 3;
+		return uint16_t((1u << line[start]) | (1u << line[start + 1]) | (1u << line[start + 2]));
+	};
 
-				// Pull the 3-cell slices from the *parameters*
-				size_t rowSliceStart = (rnd / 3) * 3;
-				size_t colSliceStart = (i   / 3) * 3;
+	// An intersection is valid when its row and column slices share only the intersection digit
+	uint16_t choices = 0;
 
-				std::array<uint8_t, 3> rowSlice = {
-					row[rowSliceStart], row[rowSliceStart+1], row[rowSliceStart+2]
-				};
-				std::array<uint8_t, 3> colSlice = {
-					col[colSliceStart], col[colSliceStart+1], col[colSliceStart+2]
-				};
+	for (size_t c = 0; c < 9; c++) {
+		size_t r = colPos[(*_row)[c]];
+		if (std::bitset<16>(sliceBits(*_row, c) & sliceBits(*_col, r)).count() == 1) choices |= uint16_t(1u << c);
+	}
 
-				// Check valid intersection
-				bool duplicateFound = false;
-				for (size_t r = 0; r < 3; r++) {
-					for (size_t c = 0; c < 3; c++) {
-						if (rowSlice[r] && colSlice[c] && rowSlice[r] == colSlice[c]) {
-							// Skip the actual intersection cell
-							size_t rowIdx = rowSliceStart + r;
-							size_t colIdx = colSliceStart + c;
-							if (!(rowIdx == rnd && colIdx == i)) {
-								duplicateFound = true;
-								break;
-							}
-						}
-					}
-					if (duplicateFound) { attempts++; break; }
-				}
+	if (!choices) return;
 
-				if (!duplicateFound) {
-					validIntersection = true;
-				} else { break; }
+	dist = std::uniform_int_distribution<size_t>(0, std::bitset<16>(choices).count() - 1);
+	size_t pick = dist(rng);
 
-				if (validIntersection) {
-					size_t bandIdx = i / 3; // band position from row index
-					size_t stackIdx = rnd / 3; // stack position from col index
+	for (rnd = 0; pick || !(choices & (1u << rnd)); rnd++) {
+		if (choices & (1u << rnd)) pick--;
+	}
 
-					// Acquire actual row and column from current grid
-					std::array<uint8_t*, 9> gridRow = getRow(i);
-					std::array<uint8_t*, 9> gridCol = getCol(rnd);
+	size_t i = colPos[(*_row)[rnd]]; // Intersection at (row i, column rnd)
 
-					for (size_t j = 0; j < 9; j++) {
-						*gridRow[j] = row[j];
-						*gridCol[j] = col[j];
-					}
+	size_t bandIdx = i / 3; // band position from row index
+	size_t stackIdx = rnd / 3; // stack position from col index
 
-					// Initialize and assign rootBox in local scope
-					Box& rootBox = getBox(bandIdx, stackIdx);
+	// Acquire actual row and column from current grid
+	std::array<uint8_t*, 9> gridRow = getRow(i);
+	std::array<uint8_t*, 9> gridCol = getCol(rnd);
 
-					findAdjs(rootBox, B_Adjs, S_Adjs);
-					findNonAdjs(rootBox, N_Adjs);
-					Phistemofel(rootBox);
+	for (size_t j = 0; j < 9; j++) {
+		*gridRow[j] = (*_row)[j];
+		*gridCol[j] = (*_col)[j];
+	}
 
-					size_t duplicateCount = 0;
+	// Initialize and assign rootBox in local scope
+	Box& rootBox = getBox(bandIdx, stackIdx);
 
-					// Step 1: prune avails[2] by digits already in rootBox
-					for (auto d : rootBox.cells) {
-						if (d) avails[2].erase(d);
-					}
+	findAdjs(rootBox, B_Adjs, S_Adjs);
+	findNonAdjs(rootBox, N_Adjs);
 
-					// Step 2: build pool[2] from remaining avails[2] and shuffle
-					pools[2].assign(avails[2].begin(), avails[2].end());
-					std::shuffle(pools[2].begin(), pools[2].end(), rng);
+	Equiv_Map ring, assoc_map;
+	Phistemofel(rootBox, ring, assoc_map);
 
-					// Step 3: fill empty cells in rootBox with remaining digits
-					size_t idx = 0;
-					for (auto& d : rootBox.cells) {
-						if (!d && idx < pools[2].size()) {
-							d = pools[2][idx++];
-						}
-					}
+	// Step 1: prune avails[2] by digits already in rootBox
+	for (auto d : rootBox.cells) {
+		if (d) avails[2].erase(d);
+	}
 
-					avails.fill(digits);
-					size_t placed = 0, _placed = 0;
-					std::vector<uint8_t*> slice1, slice2, slice3, slice4;
-					std::array<uint8_t*, 9> _gridRow{nullptr}, _gridCol{nullptr};
-
-					for (auto idx : idxList) {
-						if (B_Adjs[0]->findRowNull(idx)) { 
-							if (slice1.empty()){
-								gridRow = getRow(B_Adjs[0]->band, idx); 
-								for (auto& cell : gridRow) {
-									if (!*cell) { slice1.push_back(cell); }
-								}
-							} else {	
-								_gridRow = getRow(B_Adjs[1]->band, idx);
-								for (auto& cell : _gridRow) {
-									if (!*cell) { slice3.push_back(cell); }
-								}
-							}
-						}
+	// Step 2: build pool[2] from remaining avails[2] and shuffle
+	pools[2].assign(avails[2].begin(), avails[2].end());
+	std::shuffle(pools[2].begin(), pools[2].end(), rng);
 
-						if (S_Adjs[0]->findColNull(idx)) { 
-							if (slice2.empty()){
-								gridCol = getCol(S_Adjs[0]->stack, idx);
-								for (auto& cell : gridCol) {
-									if (!*cell) { slice2.push_back(cell); }
-								}
-							} else {	
-								_gridCol = getCol(S_Adjs[1]->stack, idx);
-								for (auto& cell : _gridCol) {
-									if (!*cell) { slice4.push_back(cell); }
-								}
-							}
-						}
-					}
+	// Step 3: fill empty cells in rootBox with remaining digits
+	size_t idx = 0;
+	for (auto& d : rootBox.cells) {
+		if (!d && idx < pools[2].size()) {
+			d = pools[2][idx++];
+		}
+	}
 
-					// Step 2: prune
-					for (size_t c = 0; c < row.size(); c++) {
-						avails[0].erase(*gridRow[c]);
-						avails[1].erase(*gridCol[c]);
-						avails[0].erase(B_Adjs[0]->cells[c]);
-						avails[1].erase(S_Adjs[0]->cells[c]);
-					}
+	avails.fill(digits);
+	size_t placed = 0, _placed = 0;
+	std::vector<uint8_t*> slice1, slice2, slice3, slice4;
+	std::array<uint8_t*, 9> _gridRow{nullptr}, _gridCol{nullptr};
+
+	for (auto idx : idxList) {
+		if (B_Adjs[0]->findRowNull(idx)) { 
+			if (slice1.empty()){
+				gridRow = getRow(bandOf(*B_Adjs[0]), idx); 
+				for (auto& cell : gridRow) {
+					if (!*cell) { slice1.push_back(cell); }
+				}
+			} else {	
+				_gridRow = getRow(bandOf(*B_Adjs[1]), idx);
+				for (auto& cell : _gridRow) {
+					if (!*cell) { slice3.push_back(cell); }
+				}
+			}
+		}
 
-					pools[0].assign(avails[0].begin(), avails[0].end());
-					pools[1].assign(avails[1].begin(), avails[1].end());
+		if (S_Adjs[0]->findColNull(idx)) { 
+			if (slice2.empty()){
+				gridCol = getCol(stackOf(*S_Adjs[0]), idx);
+				for (auto& cell : gridCol) {
+					if (!*cell) { slice2.push_back(cell); }
+				}
+			} else {	
+				_gridCol = getCol(stackOf(*S_Adjs[1]), idx);
+				for (auto& cell : _gridCol) {
+					if (!*cell) { slice4.push_back(cell); }
+				}
+			}
+		}
+	}
 
-					// Partition pools[0] so digits found in B_Adjs[1] come first
-					std::stable_partition(
-						pools[0].begin(), pools[0].end(),
-						[&](uint8_t d) {
-							return B_Adjs[1]->find(d);
-						}
-					);
+	// Step 2: prune
+	for (size_t c = 0; c < 9; c++) {
+		avails[0].erase(*gridRow[c]);
+		avails[1].erase(*gridCol[c]);
+		avails[0].erase(B_Adjs[0]->cells[c]);
+		avails[1].erase(S_Adjs[0]->cells[c]);
+	}
 
-					// Partition pools[1] so digits found in S_Adjs[1] come first
-					std::stable_partition(
-						pools[1].begin(), pools[1].end(),
-						[&](uint8_t d) {
-							return S_Adjs[1]->find(d);
-						}
-					);
+	pools[0].assign(avails[0].begin(), avails[0].end());
+	pools[1].assign(avails[1].begin(), avails[1].end());
 
-					// Step 3: force placement
-					for (auto d : pools[0]) {
-						if (placed < 3) *slice1.at(placed++) = d;
-					}
+	// Partition pools[0] so digits found in B_Adjs[1] come first
+	std::stable_partition(
+		pools[0].begin(), pools[0].end(),
+		[&](uint8_t d) {
+			return B_Adjs[1]->find(d);
+		}
+	);
 
-					for (auto d : pools[1]) {
-							if (_placed < 3) *slice2.at(_placed++) = d;
-					}
+	// Partition pools[1] so digits found in S_Adjs[1] come first
+	std::stable_partition(
+		pools[1].begin(), pools[1].end(),
+		[&](uint8_t d) {
+			return S_Adjs[1]->find(d);
+		}
+	);
 
-					for (auto& cell : gridRow) {
-						avails[2].erase(*cell);
-					}
+	// Step 3: force placement
+	for (auto d : pools[0]) {
+		if (placed < 3) *slice1.at(placed++) = d;
+	}
 
-					for (auto& cell : gridCol) {
-						avails[3].erase(*cell);
-					}
+	for (auto d : pools[1]) {
+			if (_placed < 3) *slice2.at(_placed++) = d;
+	}
 
-					pools[2].assign(avails[2].begin(), avails[2].end());
-					pools[3].assign(avails[3].begin(), avails[3].end());
+	for (auto& cell : gridRow) {
+		avails[2].erase(*cell);
+	}
 
-					for (auto d : pools[2]) {
-						*slice1.at(placed++) = d;
-					}
+	for (auto& cell : gridCol) {
+		avails[3].erase(*cell);
+	}
 
-					for (auto d : pools[3]) {
-						*slice2.at(_placed++) = d;
-					}
+	pools[2].assign(avails[2].begin(), avails[2].end());
+	pools[3].assign(avails[3].begin(), avails[3].end());
 
-					placed = 0; _placed = 0;
-					avails.fill(digits);
+	for (auto d : pools[2]) {
+		*slice1.at(placed++) = d;
+	}
 
-					for (size_t it = 0; it < avails.size(); it++) {
-						idx = (it % 2);
-						if (it < 2) {
-							for (auto digit : digits) {
-								if (B_Adjs[idx]->find(digit)) avails[it].erase(digit);
-							}
-						} else { 
-							for (auto digit : digits){
-								if (S_Adjs[idx]->find(digit)) avails[it].erase(digit);
-							}
-						}
-					}
+	for (auto d : pools[3]) {
+		*slice2.at(_placed++) = d;
+	}
 
-					for (size_t c = 0; c < pools.size(); c++) {
-						pools[c].assign(avails[c].begin(), avails[c].end());
-					}
+	placed = 0; _placed = 0;
+	avails.fill(digits);
 
-					for (size_t c = 0; c < pools.size(); c++) {
-						for (auto d : pools[c]) {
-							(c < 2) ? *slice3.at(placed++) = d : *slice4.at(_placed++) = d;
-						}
-					}
-				}
-				break;
+	for (size_t it = 0; it < avails.size(); it++) {
+		idx = (it % 2);
+		if (it < 2) {
+			for (auto digit : digits) {
+				if (B_Adjs[idx]->find(digit)) avails[it].erase(digit);
+			}
+		} else { 
+			for (auto digit : digits){
+				if (S_Adjs[idx]->find(digit)) avails[it].erase(digit);
 			}
 		}
-	} while (!validIntersection);
+	}
 
+	for (size_t c = 0; c < pools.size(); c++) {
+		pools[c].assign(avails[c].begin(), avails[c].end());
+	}
 
-	if (validIntersection) NonAdjFill(N_Adjs, B_Adjs, S_Adjs, avails, pools);
+	for (size_t c = 0; c < pools.size(); c++) {
+		for (auto d : pools[c]) {
+			(c < 2) ? *slice3.at(placed++) = d : *slice4.at(_placed++) = d;
+		}
+	}
+
+	NonAdjFill(N_Adjs, B_Adjs, S_Adjs, ring, assoc_map);
 }
 
 void Sudoku::Corner_Propag(Box& rootBox, bool empty) { /* --- Alternative propagation algorithm involving abstracted corner boxes --- */ 
@@ -1139,7 +1009,8 @@ void Sudoku::Corner_Propag(Box& rootBox, bool empty) { /* --- Alternative propag
 	 * Use the other propagation algorithms as a benchmark comparison and for insight as to how to complete this one.
 	 * It's not necessarily needed, so feel free to work on whatever.
 	 */
-	std::vector<Box*> B_Adjs, S_Adjs, N_Adjs;
+	Adjacent B_Adjs, S_Adjs;
+	NonAdjacent N_Adjs;
 
 	findNonAdjs(rootBox, N_Adjs);
 	findAdjs(rootBox, B_Adjs, S_Adjs);
@@ -1162,6 +1033,7 @@ void Sudoku::root_generate(bool type) {
 	clearGrid();
 
 	(type) ? Root_Propag(getBox(rnd), true) : Corner_Propag(getBox(rnd), true);
+	syncState();
 
 	/* --- Puzzle building section --- */
 }
@@ -1171,6 +1043,7 @@ void Sudoku::root_generate(bool type, size_t pos){
 	clearGrid();
 
 	(type) ? Root_Propag(getBox(pos), true) : Corner_Propag(getBox(pos), true);
+	syncState();
 
 	/* --- Puzzle building section --- */
 }
@@ -1193,10 +1066,61 @@ void Sudoku::root_generate(bool type, Box box, size_t pos) {
 	getBox(pos) = box;
 
 	(type) ? Root_Propag(getBox(pos), true) : Corner_Propag(getBox(pos), true);
+	syncState();
 
 	/* --- Puzzle building section --- */
 }
 
+uint64_t Sudoku::band_draw() {// Sample a stored band continuation and scramble it, with no propagation or retries
+	const BandTable& table = BandTable::instance();
+	std::uniform_int_distribution<size_t> seed(0, table.seeds().size() - 1);
+	std::uniform_int_distribution<uint64_t> code(0, Symmetry::codes - 1);
+
+	uint64_t ref = (uint64_t(seed(rng)) << Symmetry::codeBits) | code(rng);
+	band_load(ref);
+	return ref;
+}
+
+static void cycleSwap(std::array<uint8_t, 81>& g, size_t a, size_t b, size_t start, bool cols) {// Swap two lines of one band (or stack) on the columns (rows) of the digit cycle through start
+	auto at = [cols](size_t line, size_t i) { return cols ? 9 * i + line : 9 * line + i; };
+	std::array<uint8_t, 10> where; // position of each digit on line a
+	for (size_t i = 0; i < 9; i++) where[g[at(a, i)]] = uint8_t(i);
+
+	uint16_t onCycle = 0;
+	for (size_t i = start; !((onCycle >> i) & 1); i = where[g[at(b, i)]]) onCycle |= uint16_t(1u << i);
+
+	// The cycle carries the same digits on both lines, so rows, columns and boxes stay valid
+	for (size_t i = 0; i < 9; i++) {
+		if ((onCycle >> i) & 1) std::swap(g[at(a, i)], g[at(b, i)]);
+	}
+}
+
+void Sudoku::band_generate() {// A table seed reshaped by random cycle swaps, then scrambled in one gather
+	const BandTable& table = BandTable::instance();
+	std::uniform_int_distribution<size_t> seed(0, table.seeds().size() - 1);
+	std::uniform_int_distribution<uint64_t> code(0, Symmetry::codes - 1);
+
+	std::array<uint8_t, 81> cells = table.seeds()[seed(rng)];
+
+	// Swapping a line pair along a digit cycle shorter than 9 gives a grid outside the seed's class, so a handful
+	// of them lifts the engine off the table's 3,328 classes for about 60 ns each
+	for (size_t k = 0; k < bandSwaps; k++) {
+		uint32_t r = rng(); // one word per swap: line pair and start cell, bias below 2^-28
+		size_t block = r % 3, pair = (r / 3) % 3;
+		cycleSwap(cells, 3 * block + pair, 3 * block + (pair + 1) % 3, (r / 9) % 9, k & 1);
+	}
+
+	gather(cells, Symmetry::decode(code(rng)));
+}
+
+void Sudoku::band_load(uint64_t ref) {// Rebuild a grid from its corpus reference in one gather
+	const BandTable& table = BandTable::instance();
+	size_t seed = size_t(ref >> Symmetry::codeBits);
+	bounds_check(seed >= table.seeds().size(), "Corpus reference out of range")
+
+	gather(table.seeds()[seed], Symmetry::decode(ref & ((uint64_t(1) << Symmetry::codeBits) - 1)));
+}
+
 void Sudoku::line_generate(){
 	std::array<uint8_t, 9> row{1, 2, 3, 4, 5, 6, 7, 8, 9}, col{1, 2, 3, 4, 5, 6, 7, 8, 9};
 
@@ -1205,6 +1129,7 @@ void Sudoku::line_generate(){
 
 	clearGrid();
 	Line_Propag(row, col);
+	syncState();
 }
 
 void Sudoku::line_generate(std::array<uint8_t*, 9> row, std::array<uint8_t*, 9> col) {
@@ -1216,219 +1141,397 @@ void Sudoku::line_generate(std::array<uint8_t*, 9> row, std::array<uint8_t*, 9>
 
 	clearGrid();
 	Line_Propag(_row, _col);
+	syncState();
 
 	/* --- Puzzle building section --- */
 }
 
-void Sudoku::flattenGrid() {
-	size_t index = 0;
-	for (auto idx : idxList){
-		auto band = getBand(idx);
+std::vector<Sudoku> Sudoku::line_fanout(std::array<uint8_t*, 9> row, std::array<uint8_t*, 9> col, size_t count, size_t threads) {// Distinct completions of one seed row and column, generated in parallel
+	std::array<uint8_t, 9> _row, _col;
+	for (size_t i = 0; i < row.size(); i++) {
+		_row[i] = *row[i];
+		_col[i] = *col[i];
+	}
 
-		for (size_t i = 0; i < idxList.size(); i++) {
-			for (auto& box : band) {
-				for (size_t j = 0; j < idxList.size(); j++) {
-					grid[index++] = &box->cells[(i * 3) + j];
-				}
+	if (!threads) threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+	std::vector<Sudoku> results;
+	std::unordered_map<uint64_t, size_t> seen; // fingerprint -> first result carrying it
+
+	results.reserve(count);
+
+	// Attempt a draws from stream a of a key taken from the caller's generator, and batches merge in attempt order,
+	// so the result is the same for any thread count. Seeds without a valid intersection fail every attempt, so the
+	// attempt budget bounds the run.
+	const uint64_t key = (uint64_t(rng()) << 32) | rng();
+	const size_t maxAttempts = 64 * count + 1024, batch = 64 * threads;
+
+	std::vector<Sudoku> grids(batch);
+	std::vector<char> valid(batch);
+
+	for (size_t base = 0; base < maxAttempts && results.size() < count; base += batch) {
+		size_t span = std::min(batch, maxAttempts - base);
+		std::atomic<size_t> next{ 0 };
+
+		auto worker = [&]() {
+			const Philox saved = rng;
+
+			for (size_t i = next++; i < span; i = next++) {
+				Sudoku& s = grids[i];
+				rng.reseed(key, base + i);
+
+				s.clearGrid();
+				s.Line_Propag(_row, _col);
+				s.syncState();
+				valid[i] = s.validateGrid();
 			}
+
+			rng = saved;
+		};
+
+		std::vector<std::thread> pool;
+		for (size_t t = 1; t < std::min(threads, span); t++) pool.emplace_back(worker);
+		worker();
+
+		for (auto& t : pool) t.join();
+
+		for (size_t i = 0; i < span && results.size() < count; i++) {
+			if (!valid[i]) continue;
+
+			const Sudoku& s = grids[i];
+			auto hit = seen.find(s.fingerprint());
+			if (hit != seen.end() && results[hit->second] == s) continue;
+
+			seen.emplace(s.fingerprint(), results.size());
+			results.push_back(s);
 		}
 	}
+
+	return results;
 }
 
-void Sudoku::printGrid() const {
-	std::string line;
-	line.reserve(64); // enough for one row
+void Sudoku::printGrid() const {// One formatted block per grid; no per-row flush
+	char text[Format::maxBytes];
+	std::cout.write(text, std::streamsize(Format::pretty(getCells(), text)));
+}
 
-	for (size_t band = 0; band < 3; band++) {
-		for (size_t row = 0; row < 3; row++) {
-			line.clear();
-			for (size_t box_pos = 0; box_pos < 3; box_pos++) {
-				size_t pos = 3 * band + box_pos;
-				size_t rel_row = 3 * row;
-				const Box& box = boxes[pos];
+uint8_t Sudoku::getCell(size_t pos) {// Read a cell by row-major position
+	bounds_check(pos > 80, "Cell index out of range")
 
-				for (size_t rel_col = 0; rel_col < 3; rel_col++) {
-					pos = rel_row + rel_col;
-					int val = int(box.cells[pos]);
-					line.push_back(val == 0 ? '#' : '0' + val);
-					line.push_back(' ');
-				}
-				if (box_pos < 2) line += "| ";
-			}
-			std::cout << line << std::endl;
-		}
-		if (band < 2) std::cout << "------+-------+------\n";
+	const Slot& slot = cellSlots[pos];
+	return boxes[slot.box].cells[slot.cell];
+}
+
+void Sudoku::setCell(size_t pos, uint8_t val) {// Single cell edit that keeps the constraint masks current
+	bounds_check(pos > 80 || val > 9, "Cell index or digit out of range")
+
+	const Slot& slot = cellSlots[pos];
+	uint8_t& cell = boxes[slot.box].cells[slot.cell];
+
+	if (cell == val) return;
+
+	// Masks can't tell which duplicate a removal clears, so inconsistent grids are rebuilt instead
+	if (!consistent) { cell = val; syncState(); return; }
+
+	size_t r = pos / 9, c = pos % 9, b = slot.box;
+
+	hash ^= zobrist[pos][cell] ^ zobrist[pos][val];
+
+	if (cell) {
+		uint16_t keep = uint16_t(~(1u << cell));
+		rowMask[r] &= keep; colMask[c] &= keep; boxMask[b] &= keep;
+		filled--;
+	}
+
+	cell = val;
+
+	if (val) {
+		uint16_t bit = uint16_t(1u << val);
+		if ((rowMask[r] | colMask[c] | boxMask[b]) & bit) consistent = false;
+		rowMask[r] |= bit; colMask[c] |= bit; boxMask[b] |= bit;
+		filled++;
 	}
+}
 
-	std::cout << '\n' << std::endl;
+void Sudoku::resetState() {
+	rowMask.fill(0); colMask.fill(0); boxMask.fill(0);
+	filled = 0;
+	consistent = true;
+	hash = 0;
 }
 
-bool Sudoku::validateGrid() {
-	for (auto each : grid) {
-		if (!each || !*each) return false;
+inline void Sudoku::track(size_t pos, size_t box, uint8_t val) {// Fold one placed cell into the masks, count and fingerprint
+	if (!val) return;
+
+	size_t r = pos / 9, c = pos % 9;
+	uint16_t bit = uint16_t(1u << val);
+
+	hash ^= zobrist[pos][val];
+	if ((rowMask[r] | colMask[c] | boxMask[box]) & bit) consistent = false;
+	rowMask[r] |= bit; colMask[c] |= bit; boxMask[box] |= bit;
+	filled++;
+}
+
+void Sudoku::syncState() {// Single pass rebuild of the unit masks, validity state and fingerprint
+	resetState();
+
+	for (size_t pos = 0; pos < 81; pos++) {
+		const Slot& slot = cellSlots[pos];
+		track(pos, slot.box, boxes[slot.box].cells[slot.cell]);
 	}
+}
 
-	for (size_t i = 0; i < 9; i++) {
-		std::array<uint8_t*, 9> row = getRow(i), col = getCol(i);
-		for (size_t j = 0; j < 9; j++) {
-			for (size_t k = (j + 1); k < 9; k++) {
-				if (*row[j] == *row[k]) return false;
-				if (*col[j] == *col[k]) return false;
-				if (boxes[i].cells[j] == boxes[i].cells[k]) return false;
-			}
-		}
+std::array<uint8_t, 81> Sudoku::getCells() const {
+	std::array<uint8_t, 81> cells;
+
+	for (size_t pos = 0; pos < 81; pos++) {
+		const Slot& slot = cellSlots[pos];
+		cells[pos] = boxes[slot.box].cells[slot.cell];
 	}
 
-	return true;
+	return cells;
+}
+
+void Sudoku::setCells(const std::array<uint8_t, 81>& cells) {
+	resetState();
+
+	for (size_t pos = 0; pos < 81; pos++) {
+		const Slot& slot = cellSlots[pos];
+		boxes[slot.box].cells[slot.cell] = cells[pos];
+		track(pos, slot.box, cells[pos]);
+	}
+}
+
+void Sudoku::gather(const std::array<uint8_t, 81>& src, const Symmetry& sym) {// Fused permute, relabel and state rebuild
+	resetState();
+
+	for (size_t pos = 0; pos < 81; pos++) {
+		const Slot& slot = cellSlots[pos];
+		size_t r = sym.rows[pos / 9], c = sym.cols[pos % 9];
+		uint8_t val = sym.digits[src[sym.transpose ? 9 * c + r : 9 * r + c]];
+
+		boxes[slot.box].cells[slot.cell] = val;
+		track(pos, slot.box, val);
+	}
+}
+
+void Sudoku::applySymmetry(const Symmetry& sym) {
+	gather(getCells(), sym);
+}
+
+uint64_t Sudoku::randomizeEquivalent() {
+	uint64_t code = std::uniform_int_distribution<uint64_t>(0, Symmetry::codes - 1)(rng);
+	gather(getCells(), Symmetry::decode(code));
+	return code;
 }
 
-void Sudoku::clearGrid(){
-	for (auto& each : boxes){
-		for (auto& cell : each.cells){
-			cell = 0;
+void Sudoku::rehash() {// Recompute the fingerprint in one pass, for moves that touch every cell
+	hash = 0;
+	for (size_t pos = 0; pos < 81; pos++) {
+		const Slot& slot = cellSlots[pos];
+		hash ^= zobrist[pos][boxes[slot.box].cells[slot.cell]];
+	}
+}
+
+void Sudoku::swapCells(size_t pos1, size_t pos2) {// Swap two row-major cells and patch the fingerprint
+	const Slot& slot1 = cellSlots[pos1];
+	const Slot& slot2 = cellSlots[pos2];
+	uint8_t& cell1 = boxes[slot1.box].cells[slot1.cell];
+	uint8_t& cell2 = boxes[slot2.box].cells[slot2.cell];
+
+	hash ^= zobrist[pos1][cell1] ^ zobrist[pos1][cell2] ^ zobrist[pos2][cell1] ^ zobrist[pos2][cell2];
+	std::swap(cell1, cell2);
+}
+
+void Sudoku::swapBoxes(size_t pos1, size_t pos2) {// Swap two whole boxes and patch the fingerprint
+	for (size_t k = 0; k < 9; k++) {
+		size_t p1 = boxCellPos[9 * pos1 + k], p2 = boxCellPos[9 * pos2 + k];
+		uint8_t a = boxes[pos1].cells[k], b = boxes[pos2].cells[k];
+		hash ^= zobrist[p1][a] ^ zobrist[p1][b] ^ zobrist[p2][a] ^ zobrist[p2][b];
+	}
+
+	std::swap(boxes[pos1], boxes[pos2]);
+}
+
+void Sudoku::relabelMasks(const std::array<uint8_t, 10>& mapping) {// Carry the unit masks through a digit relabeling
+	if (consistent && filled == 81) return; // Full units stay full under any relabeling
+
+	auto relabel = [&](uint16_t mask) {
+		uint16_t out = 0;
+		for (uint8_t d = 1; d <= 9; d++) {
+			if (mask & (1u << d)) out |= uint16_t(1u << (mapping[d] ? mapping[d] : d));
 		}
+		return out;
+	};
+
+	for (size_t i = 0; i < 9; i++) {
+		rowMask[i] = relabel(rowMask[i]);
+		colMask[i] = relabel(colMask[i]);
+		boxMask[i] = relabel(boxMask[i]);
 	}
+}
 
-	ring.fill(nullptr);
-	assoc_map.fill(nullptr);
+void Sudoku::clearGrid(){// A grid is its cells and their state, so clearing is one memset and a state reset
+	std::memset(static_cast<void*>(boxes.data()), 0, sizeof(boxes));
+	resetState();
 }
 
-void Sudoku::populate(std::string g) {
-	for (size_t i = 0; i < grid.size(); ++i) {
+void Sudoku::populate(const std::string& g) {// Bulk files go through Ingest; this is the forgiving single-grid path
+	if (g.size() < 81) throw std::invalid_argument("Grid string needs 81 cells"); // checked in release builds too
+
+	std::array<uint8_t, 81> cells;
+	for (size_t i = 0; i < 81; ++i) {
 		char c = g[i];
-		if (c >= '1' && c <= '9') {
-			*grid[i] = static_cast<uint8_t>(c - '0'); // convert char digit to number
-		} else {
-			*grid[i] = 0; // treat '.' or '0' or any non-digit as blank
-		}
+		cells[i] = (c >= '1' && c <= '9') ? static_cast<uint8_t>(c - '0') : 0; // treat '.' or '0' or any non-digit as blank
 	}
+
+	setCells(cells);
+}
+
+bool Sudoku::complete() {
+	std::array<uint8_t, 81> cells = getCells();
+	if (!consistent || !Solver().complete(cells)) return false;
+
+	setCells(cells);
+	return true;
 }
 
 std::string Sudoku::toString() {
-	std::string s;
-	s.reserve(81);
-	for (size_t i = 0; i < grid.size(); ++i) {
-		if (*grid[i] == 0) {
-			s.push_back('.'); // tdoku uses '.' or '0' for blanks
-		} else {
-			s.push_back('0' + *grid[i]); // convert digit to char
-		}
-	}
-	return s;
+	char text[Format::maxBytes];
+	return std::string(text, Format::line(getCells(), text) - 1); // without the newline
 }
 
 void Sudoku::torShift(size_t r_shift, size_t c_shift) {
+	Perf::Scope scope(Perf::TorShift);
 	if (r_shift >= 3 || c_shift >= 3) return;
 
 	std::array<Box, 9> temp;
+	std::array<uint16_t, 9> rows, cols, _boxes;
 
-	for (Box& box : boxes) {
-		size_t band_shift = (box.band + r_shift) % 3;
-		size_t stack_shift = (box.stack + c_shift) % 3;
+	for (size_t pos = 0; pos < boxes.size(); pos++) {
+		Box& box = boxes[pos];
+		size_t band_shift = (pos / 3 + r_shift) % 3;
+		size_t stack_shift = (pos % 3 + c_shift) % 3;
 		size_t new_index = 3 * band_shift + stack_shift;
 
-		box.band = band_shift;
-		box.stack = stack_shift;
+		// Lines move with their boxes, so the unit masks follow the same permutation
+		for (size_t k = 0; k < 3; k++) {
+			rows[3 * band_shift + k] = rowMask[3 * (pos / 3) + k];
+			cols[3 * stack_shift + k] = colMask[3 * (pos % 3) + k];
+		}
+		_boxes[new_index] = boxMask[pos];
+
 		temp[new_index] = box;
 	}
 
 	boxes = temp;
+	rowMask = rows; colMask = cols; boxMask = _boxes;
+	rehash();
 };
 
 void Sudoku::bandSwap(size_t idx1, size_t idx2) {
+	Perf::Scope scope(Perf::BandSwap);
 	if (idx1 == idx2 || idx1 > 2 || idx2 > 2) return;
 
-	auto band1 = getBand(idx1); // returns std::array<Box*,3>
-	auto band2 = getBand(idx2);
-
-	for (size_t i = 0; i < band1.size(); i++){
-		std::swap(*band1[i], *band2[i]);
+	for (size_t i = 0; i < 3; i++){
+		swapBoxes(3 * idx1 + i, 3 * idx2 + i);
+		std::swap(rowMask[3 * idx1 + i], rowMask[3 * idx2 + i]);
+		std::swap(boxMask[3 * idx1 + i], boxMask[3 * idx2 + i]);
 	}
 }
 
 void Sudoku::bandRowSwap(size_t band, size_t idx1, size_t idx2) {
+	Perf::Scope scope(Perf::BandRowSwap);
 	if (band > 2 || idx1 == idx2 || idx1 > 2 || idx2 > 2) return;
 
-	auto row1 = getRow(band, idx1);
-	auto row2 = getRow(band, idx2);
+	size_t row1 = 9 * (3 * band + idx1), row2 = 9 * (3 * band + idx2);
 
-	for (size_t i = 0; i < row1.size(); i++){
-		std::swap(*row1[i], *row2[i]);
+	for (size_t i = 0; i < 9; i++){
+		swapCells(row1 + i, row2 + i);
 	}
+
+	std::swap(rowMask[3 * band + idx1], rowMask[3 * band + idx2]);
 }
 
 void Sudoku::stackSwap(size_t idx1, size_t idx2) {
+	Perf::Scope scope(Perf::StackSwap);
 	if (idx1 == idx2 || idx1 > 2 || idx2 > 2) return;
 
-	auto stack1 = getStack(idx1); // returns std::array<Box*,3>
-	auto stack2 = getStack(idx2);
-
-	for (size_t i = 0; i < stack1.size(); i++){
-		std::swap(*stack1[i], *stack2[i]);
+	for (size_t i = 0; i < 3; i++){
+		swapBoxes(idx1 + 3 * i, idx2 + 3 * i);
+		std::swap(colMask[3 * idx1 + i], colMask[3 * idx2 + i]);
+		std::swap(boxMask[idx1 + 3 * i], boxMask[idx2 + 3 * i]);
 	}
 }
 
 void Sudoku::stackColSwap(size_t stack, size_t idx1, size_t idx2) {
+	Perf::Scope scope(Perf::StackColSwap);
 	if (stack > 2 || idx1 == idx2 || idx1 > 2 || idx2 > 2) return;
 
-	auto col1 = getCol(stack, idx1);
-	auto col2 = getCol(stack, idx2);
+	size_t col1 = 3 * stack + idx1, col2 = 3 * stack + idx2;
 
-	for (size_t i = 0; i < col1.size(); i++){
-		std::swap(*col1[i], *col2[i]);
+	for (size_t i = 0; i < 9; i++){
+		swapCells(9 * i + col1, 9 * i + col2);
 	}
+
+	std::swap(colMask[3 * stack + idx1], colMask[3 * stack + idx2]);
 }
 
 void Sudoku::reflection(bool type) {
-	auto swapLines = [&](std::array<uint8_t*, 9> line1, std::array<uint8_t*, 9> line2){
+	Perf::Scope scope(Perf::Reflection);
+	for (size_t i = 0; i < (9 / 2); i++)  {
+		size_t opp = 8 - i;
+
 		for (size_t j = 0; j < 9; j++) {
-			std::swap(*line1[j], *line2[j]);
+			if (type) swapCells(9 * i + j, 9 * opp + j);
+			else swapCells(9 * j + i, 9 * j + opp);
 		}
-		};
+	}
 
-	for (size_t i = 0; i < (9 / 2); i++)  {
-		if (type){
-			auto row1 = getRow(i);
-			auto row2 = getRow((boxes.size() - (i + 1)));
-			swapLines(row1, row2);
-		} else {
-			auto col1 = getCol(i);
-			auto col2 = getCol((boxes.size() - (i + 1)));
-			swapLines(col1, col2);
-		}
+	// Reversing the lines also reverses the bands (or stacks) holding them
+	if (type) {
+		std::reverse(rowMask.begin(), rowMask.end());
+		for (size_t i = 0; i < 3; i++) std::swap(boxMask[i], boxMask[6 + i]);
+	} else {
+		std::reverse(colMask.begin(), colMask.end());
+		for (size_t i = 0; i < 3; i++) std::swap(boxMask[3 * i], boxMask[3 * i + 2]);
 	}
 }
 
 void Sudoku::transpose() {
-	auto swapLines = [&](std::array<uint8_t*, 9> line1, std::array<uint8_t*, 9> line2, size_t idx) {
-		for (size_t j = idx + 1; j < 9; j++) {
-			std::swap(*line1[j], *line2[j]);
-		}
-	};
-
+	Perf::Scope scope(Perf::Transpose);
 	for (size_t i = 0; i < 9; i++) {
-		auto row = getRow(i);
-		auto col = getCol(i);
-		swapLines(row, col, i);
+		for (size_t j = i + 1; j < 9; j++) {
+			swapCells(9 * i + j, 9 * j + i);
+		}
 	}
+
+	std::swap(rowMask, colMask);
+	std::swap(boxMask[1], boxMask[3]);
+	std::swap(boxMask[2], boxMask[6]);
+	std::swap(boxMask[5], boxMask[7]);
 }
 
 void Sudoku::rotation() {
+	Perf::Scope scope(Perf::Rotation);
 	transpose();
 	reflection(true);
 }
 
 void Sudoku::_rotation() {
+	Perf::Scope scope(Perf::InverseRotation);
 	transpose();
 	reflection(false);
 }
 
 void Sudoku::_transpose(){
+	Perf::Scope scope(Perf::InverseTranspose);
 	_rotation();
 	reflection(true);
 }
 
 void Sudoku::digPermut(uint8_t count, uint8_t initPart) {
+	Perf::Scope scope(Perf::DigPermut);
 	if (count > 18 || initPart < 2 || initPart > 9) return;
 
 	// Start with one partition of size initPart
@@ -1500,19 +1603,171 @@ void Sudoku::digPermut(uint8_t count, uint8_t initPart) {
 	}
 
 	// mapping is std::array<uint8_t, 10> built from partitions
-	// grid is a flattened view of 81 cells (uint8_t* grid)
+	// boxes are walked in storage order, boxCellPos gives each cell's grid position for the fingerprint
 
-	for (size_t i = 0; i < grid.size(); ++i) {
-		uint8_t val = *grid[i];
+	for (size_t i = 0; i < 81; ++i) {
+		uint8_t& cell = boxes[i / 9].cells[i % 9];
+		uint8_t val = cell;
 		if (val >= 1 && val <= 9) {
 			// Only remap if mapping[val] is non-zero
 			if (mapping[val] != 0) {
-				*grid[i] = mapping[val];
+				hash ^= zobrist[boxCellPos[i]][val] ^ zobrist[boxCellPos[i]][mapping[val]];
+				cell = mapping[val];
 			}
 			// else leave unchanged (fixed point)
 		}
 		// If val == 0, treat as blank and skip
 	}
+
+	relabelMasks(mapping);
+}
+
+/* --- Toroidal variant --- */
+
+void Toroidal_Sudoku::setOffsets(size_t rows, size_t cols) {
+	rowShift = rows % 9;
+	colShift = cols % 9;
+
+	for (size_t r = 0; r < 9; r++) {
+		for (size_t c = 0; c < 9; c++) {
+			regionMap[9 * r + c] = uint8_t(3 * (((r + rowShift) % 9) / 3) + ((c + colShift) % 9) / 3);
+		}
+	}
 }
 
-void Toroidal_Sudoku::torShift(size_t r_shift, size_t c_shift) { return; }
+void Toroidal_Sudoku::toroidal_generate(bool band) {
+	setOffsets(0, 0);
+	do { if (band) Sudoku::band_generate(); else Sudoku::root_generate(true); } while (!Sudoku::validateGrid());
+
+	// Offsets that are both multiples of 3 would give plain boxes again
+	std::uniform_int_distribution<size_t> dist(0, 8);
+	size_t r, c;
+	do { r = dist(rng); c = dist(rng); } while (r % 3 == 0 && c % 3 == 0);
+
+	lineShift(r, c);
+}
+
+void Toroidal_Sudoku::lineShift(size_t r_shift, size_t c_shift) {
+	Perf::Scope scope(Perf::TorShift);
+	r_shift %= 9; c_shift %= 9;
+	if (!r_shift && !c_shift) return;
+
+	std::array<uint8_t, 81> cells = getCells(), shifted;
+
+	for (size_t r = 0; r < 9; r++) {
+		size_t to = 9 * ((r + r_shift) % 9);
+		for (size_t c = 0; c < 9; c++) shifted[to + (c + c_shift) % 9] = cells[9 * r + c];
+	}
+
+	setCells(shifted);
+
+	// Cell (r, c) now holds what sat at (r - r_shift, c - c_shift), region included
+	setOffsets(rowShift + 9 - r_shift, colShift + 9 - c_shift);
+}
+
+void Toroidal_Sudoku::torShift(size_t b_shift, size_t s_shift) {
+	if (b_shift >= 3 || s_shift >= 3) return;
+	lineShift(3 * b_shift, 3 * s_shift);
+}
+
+bool Toroidal_Sudoku::scan(bool complete) const {
+	std::array<uint8_t, 81> cells = getCells();
+	std::array<uint16_t, 9> rows{}, cols{}, regions{};
+
+	for (size_t pos = 0; pos < 81; pos++) {
+		uint8_t val = cells[pos];
+		if (!val) { if (complete) return false; continue; }
+
+		uint16_t bit = uint16_t(1u << val);
+		uint16_t& row = rows[pos / 9], & col = cols[pos % 9], & region = regions[regionMap[pos]];
+		if ((row | col | region) & bit) return false;
+
+		row |= bit; col |= bit; region |= bit;
+	}
+
+	return true;
+}
+
+bool Toroidal_Sudoku::validateGrid() const { return filled == 81 && scan(true); }
+
+bool Toroidal_Sudoku::isConsistent() const { return scan(false); }
+
+bool Toroidal_Sudoku::complete() {// Cell (r, c) goes to (r + rowOffset, c + colOffset), where its region is a plain box
+	size_t r = rowShift, c = colShift;
+	lineShift(r, c);
+	bool done = Sudoku::complete();
+	lineShift(9 - r, 9 - c);
+	return done;
+}
+
+void Toroidal_Sudoku::setCell(size_t pos, uint8_t val) {
+	Sudoku::setCell(pos, val);
+	consistent = scan(false);
+}
+
+void Toroidal_Sudoku::root_generate(bool type) { onBoxes([&] { Sudoku::root_generate(type); }); }
+
+void Toroidal_Sudoku::root_generate(bool type, size_t pos) { onBoxes([&] { Sudoku::root_generate(type, pos); }); }
+
+void Toroidal_Sudoku::root_generate(bool type, Box box, size_t pos) { onBoxes([&] { Sudoku::root_generate(type, box, pos); }); }
+
+void Toroidal_Sudoku::band_generate() { onBoxes([&] { Sudoku::band_generate(); }); }
+
+void Toroidal_Sudoku::band_load(uint64_t ref) { onBoxes([&] { Sudoku::band_load(ref); }); }
+
+void Toroidal_Sudoku::line_generate() { onBoxes([&] { Sudoku::line_generate(); }); }
+
+void Toroidal_Sudoku::line_generate(std::array<uint8_t*, 9> row, std::array<uint8_t*, 9> col) {
+	onBoxes([&] { Sudoku::line_generate(row, col); }); // the base reads row and col before it clears the grid
+}
+
+void Toroidal_Sudoku::gather(const std::array<uint8_t, 81>& src, const Symmetry& sym) {// Cell (r, c) of src sits at (r + rowOffset, c + colOffset) on plain boxes
+	std::array<uint8_t, 81> plain;
+	for (size_t r = 0; r < 9; r++) {
+		size_t to = 9 * ((r + rowShift) % 9);
+		for (size_t c = 0; c < 9; c++) plain[to + (c + colShift) % 9] = src[9 * r + c];
+	}
+
+	onBoxes([&] { Sudoku::gather(plain, sym); });
+}
+
+// Band and stack moves: shift the region bands (or stacks) onto the box lines, move them there, and shift back
+void Toroidal_Sudoku::bandSwap(size_t idx1, size_t idx2) {
+	size_t shift = rowShift;
+	lineShift(shift, 0);
+	Sudoku::bandSwap(idx1, idx2);
+	lineShift(9 - shift, 0);
+}
+
+void Toroidal_Sudoku::bandRowSwap(size_t band, size_t idx1, size_t idx2) {
+	size_t shift = rowShift;
+	lineShift(shift, 0);
+	Sudoku::bandRowSwap(band, idx1, idx2);
+	lineShift(9 - shift, 0);
+}
+
+void Toroidal_Sudoku::stackSwap(size_t idx1, size_t idx2) {
+	size_t shift = colShift;
+	lineShift(0, shift);
+	Sudoku::stackSwap(idx1, idx2);
+	lineShift(0, 9 - shift);
+}
+
+void Toroidal_Sudoku::stackColSwap(size_t stack, size_t idx1, size_t idx2) {
+	size_t shift = colShift;
+	lineShift(0, shift);
+	Sudoku::stackColSwap(stack, idx1, idx2);
+	lineShift(0, 9 - shift);
+}
+
+// Reversing the lines takes a region offset o to 3 - o (mod 9)
+void Toroidal_Sudoku::reflection(bool type) {
+	Sudoku::reflection(type);
+	if (type) setOffsets(12 - rowShift, colShift);
+	else setOffsets(rowShift, 12 - colShift);
+}
+
+void Toroidal_Sudoku::transpose() {
+	Sudoku::transpose();
+	setOffsets(colShift, rowShift);
+}
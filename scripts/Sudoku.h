@@ -3,33 +3,58 @@
 #define Sudoku_H
 
 #include <cstdint>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <array>
 #include <set>
+#include <stdexcept>
+
+struct Symmetry;
+
+// Bounds checks only exist in debug builds; release builds index directly
+#ifndef NDEBUG
+  #define bounds_check(cond, msg) if (cond) throw std::out_of_range(msg);
+#else
+  #define bounds_check(cond, msg)
+#endif
 
 class Sudoku {
 
-private:
+protected:
 
   struct Box {
 
     std::array<uint8_t, 9> cells = { 0 };
 
-    size_t band = 0;
-    size_t stack = 0;
+    // Strided view over the three cells of a box row (stride 1) or column (stride 3)
+    struct Line {
+      uint8_t* base;
+      size_t stride;
+
+      struct iterator {
+        uint8_t* base;
+        size_t stride;
+        size_t i;
+
+        uint8_t& operator*() const { return base[i * stride]; }
+        iterator& operator++() { i++; return *this; }
+        bool operator!=(const iterator& other) const { return i != other.i; }
+      };
+
+      uint8_t& operator[](size_t i) const { bounds_check(i > 2, "Line index out of range") return base[i * stride]; }
+
+      iterator begin() const { return { base, stride, 0 }; }
+      iterator end() const { return { base, stride, 3 }; }
+    };
 
     // Returns a cell by reference through row and column coordinates
     uint8_t& cell(size_t r, size_t c) { size_t pos = 3 * r + c;  return cells[pos]; }
 
-    // Returns an array of references for the numeric position indicating the relevant row
-    std::array<std::reference_wrapper<uint8_t>, 3> row(size_t pos) {
-        return { std::ref(cell(pos, 0)), std::ref(cell(pos, 1)), std::ref(cell(pos, 2)) };
-    }
-    // Returns an array of references for the numeric position indicating the relevant column
-    std::array<std::reference_wrapper<uint8_t>, 3> col(size_t pos) {
-        return { std::ref(cell(0, pos)), std::ref(cell(1, pos)), std::ref(cell(2, pos)) };
-    }
+    // Returns a view of the numeric position indicating the relevant row
+    Line row(size_t pos) { bounds_check(pos > 2, "Box row out of range") return { &cells[3 * pos], 1 }; }
+    // Returns a view of the numeric position indicating the relevant column
+    Line col(size_t pos) { bounds_check(pos > 2, "Box column out of range") return { &cells[pos], 3 }; }
 
     bool find(uint8_t val);
 
@@ -41,50 +66,80 @@ private:
 
   };
 
+private:
+
+  // Boxes hold nothing but their cells, so the whole grid is one contiguous 81-byte block
   std::array<Box, 9> boxes;
+  static_assert(sizeof(std::array<Box, 9>) == 81, "boxes must stay a flat 81-byte block");
 
-  const std::array<size_t, 3> idxList = { 0, 1, 2 };
-  const std::set<uint8_t> digits = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+  static constexpr std::array<size_t, 3> idxList = { 0, 1, 2 };
+  static inline const std::set<uint8_t> digits = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+  static constexpr size_t bandSwaps = 16;
+
+  // A box's band and stack follow from where it sits in boxes
+  size_t bandOf(const Box& box) const { return size_t(&box - boxes.data()) / 3; }
+  size_t stackOf(const Box& box) const { return size_t(&box - boxes.data()) % 3; }
+
+  // Boxes sharing the root's band or stack (two each), and the four sharing neither, row-major
+  using Adjacent = std::array<Box*, 2>;
+  using NonAdjacent = std::array<Box*, 4>;
+  // Phistemofel ring and corner cells, resolved per call from rootLayouts rather than kept in every grid
+  using Equiv_Map = std::array<uint8_t*, 16>;
 
-  void findNonAdjs(Box& rootBox, std::vector<Box*>& nAdjs);
-  void findAdjs(Box& rootBox, std::vector<Box*>& bAdjs, std::vector<Box*>& sAdjs);
+  void findNonAdjs(const Box& rootBox, NonAdjacent& nAdjs);
+  void findAdjs(const Box& rootBox, Adjacent& bAdjs, Adjacent& sAdjs);
 
-  void NonAdjFill(std::vector<Box*> Non_Adjs, std::vector<Box*> B_Adjs, std::vector<Box*> S_Adjs, std::array<std::set<uint8_t>, 4> avails, std::array<std::vector<uint8_t>, 4> pools);
+  void NonAdjFill(const NonAdjacent& Non_Adjs, const Adjacent& B_Adjs, const Adjacent& S_Adjs, const Equiv_Map& ring, const Equiv_Map& assoc_map);
 
 protected:
 
-  using Equiv_Map = std::array<uint8_t*, 16>;
+  // Digit presence per unit (bit d set when digit d is placed), kept current across transforms and edits
+  std::array<uint16_t, 9> rowMask{}, colMask{}, boxMask{};
+  uint8_t filled = 0;
+  bool consistent = true;
+
+  // Zobrist fingerprint of the cell contents, updated by every edit and transform
+  uint64_t hash = 0;
+
+  void track(size_t pos, size_t box, uint8_t val);
+  void resetState();
+  void relabelMasks(const std::array<uint8_t, 10>& mapping);
+  void swapCells(size_t pos1, size_t pos2);
+  void swapBoxes(size_t pos1, size_t pos2);
+  void rehash();
 
-  Equiv_Map ring = { nullptr };
-  Equiv_Map assoc_map = { nullptr };
+  // The Phistemofel ring around rootBox and the corner cells of its non-adjacent boxes, resolved to this grid
+  void Phistemofel(const Box& rootBox, Equiv_Map& ring, Equiv_Map& assoc_map);
 
-  void Phistemofel(Box& rootBox);
-  void flattenGrid();
+  // Root_Propag specialized for the root box at boxes[Root], with its neighbours and ring resolved at compile time
+  template <size_t Root> void rootPropag(bool empty);
 
   virtual void Root_Propag(Box& rootBox, bool empty = true);
   virtual void Corner_Propag(Box& rootBox, bool empty = true);
-  virtual void Line_Propag(std::array<uint8_t, 9> row, std::array<uint8_t, 9> col);
+  virtual void Line_Propag(const std::array<uint8_t, 9>& row, const std::array<uint8_t, 9>& col);
 
 public:
 
-  std::array<uint8_t*, 81> grid{nullptr};
-
   Sudoku();
+  Sudoku(const Sudoku& source) { *this = source; }
   Sudoku& operator=(const Sudoku& source) {
     if (this == &source) return *this;  // self-assignment check
-      
-    this->boxes = source.boxes;
+
+    std::memcpy(this->boxes.data(), source.boxes.data(), sizeof(boxes));
+    this->rowMask = source.rowMask;
+    this->colMask = source.colMask;
+    this->boxMask = source.boxMask;
+    this->filled = source.filled;
+    this->consistent = source.consistent;
+    this->hash = source.hash;
 
     return *this;  
   }
 
-  bool operator==(const Sudoku& source) {
-
-    for (size_t i = 0; i < grid.size(); i++) {
-      if ( !(*grid[i] == *source.grid[i]) ) return false;
-    }
+  bool operator==(const Sudoku& source) const {
+    if (hash != source.hash) return false; // Fingerprints settle nearly every mismatch without a scan
 
-    return true;
+    return std::memcmp(boxes.data(), source.boxes.data(), sizeof(boxes)) == 0;
   }
 
   Box& getBox(size_t pos);
@@ -102,29 +157,148 @@ public:
   const bool findRowVal(size_t pos, uint8_t val);
   const bool findColVal(size_t pos, uint8_t val);
 
-  void root_generate(bool type);
-  void root_generate(bool type, size_t pos);
-  void root_generate(bool type, Box box, size_t pos);
-  void line_generate();
-  void line_generate(std::array<uint8_t*, 9> row, std::array<uint8_t*, 9> col);
-  void populate(std::string g);
-
+  // Generators are virtual so a variant can fill its own regions
+  virtual void root_generate(bool type);
+  virtual void root_generate(bool type, size_t pos);
+  virtual void root_generate(bool type, Box box, size_t pos);
+  // Band engine: a stored continuation of a random top band class, reshaped by bandSwaps random line-pair cycle
+  // swaps and scrambled by a random symmetry, so grids are not confined to the table's classes
+  virtual void band_generate();
+  // A stored continuation under a random symmetry, returned as its corpus reference for band_load; the table holds
+  // 3,328 essentially different grids (8 per band class), so these repeat classes
+  uint64_t band_draw();
+  virtual void band_load(uint64_t ref);
+  virtual void line_generate();
+  virtual void line_generate(std::array<uint8_t*, 9> row, std::array<uint8_t*, 9> col);
+  static std::vector<Sudoku> line_fanout(std::array<uint8_t*, 9> row, std::array<uint8_t*, 9> col, size_t count, size_t threads = 0);
+  // 81 characters, digits 1-9 as clues and anything else blank; throws std::invalid_argument when shorter
+  void populate(const std::string& g);
+
+  // Fills the blanks of the current (partial) grid with a random completion; false, leaving the grid as is, when
+  // the clues are inconsistent or admit no completion
+  virtual bool complete();
+
+  // Transforms a variant must follow with its regions are virtual; rotations and the inverse transpose are built
+  // from transpose and reflection, so they follow through those
   virtual void torShift(size_t b_shift, size_t s_shift);
 
-  void bandSwap(size_t idx1, size_t idx2);
-  void bandRowSwap(size_t band, size_t idx1, size_t idx2);
-  void stackSwap(size_t idx1, size_t idx2); 
-  void stackColSwap(size_t stack, size_t idx1, size_t idx2);
+  virtual void bandSwap(size_t idx1, size_t idx2);
+  virtual void bandRowSwap(size_t band, size_t idx1, size_t idx2);
+  virtual void stackSwap(size_t idx1, size_t idx2); 
+  virtual void stackColSwap(size_t stack, size_t idx1, size_t idx2);
   void digPermut(uint8_t count, uint8_t initPart);
-  void reflection(bool type);
+  virtual void reflection(bool type);
   void rotation();
   void _rotation();
-  void transpose();
+  virtual void transpose();
   void _transpose();
 
-  bool validateGrid();
+  uint8_t getCell(size_t pos);
+  virtual void setCell(size_t pos, uint8_t val);
+
+  // Row-major copies of all 81 cells
+  std::array<uint8_t, 81> getCells() const;
+  void setCells(const std::array<uint8_t, 81>& cells);
+
+  // Rebuild this grid as the image of src (row-major) under sym in one pass; applySymmetry, randomizeEquivalent and
+  // the band engine go through it
+  virtual void gather(const std::array<uint8_t, 81>& src, const Symmetry& sym);
+  void applySymmetry(const Symmetry& sym);
+
+  // Scrambles the grid into a uniformly random equivalent one: a single draw from the 41-bit symmetry code space,
+  // decoded and applied as one gather. Returns the code, so the scramble can be replayed or undone
+  uint64_t randomizeEquivalent();
+
+  uint16_t rowDigits(size_t pos) const { return rowMask[pos]; }
+  uint16_t colDigits(size_t pos) const { return colMask[pos]; }
+  uint16_t boxDigits(size_t pos) const { return boxMask[pos]; }
+
+  uint64_t fingerprint() const { return hash; }
+
+  // Rebuilds the constraint masks and fingerprint after cells were written directly through getRow/getCol or getBox
+  void syncState();
+
+  virtual bool validateGrid() const { return consistent && filled == 81; }
+  virtual bool isConsistent() const { return consistent; } // no unit repeats a digit, blanks allowed
   void clearGrid();
 
   void printGrid() const;
   std::string toString();
 };
+
+// Toroidal variant: every region is a 3x3 block of the torus, the box grid shifted by (rowOffset, colOffset) cells
+// with wraparound, so regions cross the grid edges unless both offsets are multiples of 3. Cell (r, c) belongs to
+// the region of standard box ((r + rowOffset) % 9, (c + colOffset) % 9). Only these shifted-box layouts are
+// covered, not arbitrary wraparound region shapes. A toroidal grid is a standard grid shifted line by line, so
+// generation is one standard generation plus one 81-cell pass, with no search. Every generator and transform of the
+// base is overridden to keep to the current regions, so the class can be used through Sudoku&: generators fill the
+// current layout, and gather (with applySymmetry and randomizeEquivalent) reads its source as laid out on it.
+class Toroidal_Sudoku : public Sudoku {
+
+public:
+
+  Toroidal_Sudoku() { setOffsets(0, 0); }
+
+  // Standard grid from the root (or band) engine, then a random line shift that leaves the regions wrapping
+  void toroidal_generate(bool band = false);
+
+  size_t rowOffset() const { return rowShift; }
+  size_t colOffset() const { return colShift; }
+
+  // Row-major region map, one region index (0..8) per cell
+  const std::array<uint8_t, 81>& regions() const { return regionMap; }
+
+  // Cyclic shift by whole lines, r_shift rows down and c_shift columns right (0..8); the regions travel with the cells
+  void lineShift(size_t r_shift, size_t c_shift);
+
+  // Same meaning as the base: whole bands and stacks (0..2), as lineShift by three lines each
+  void torShift(size_t b_shift, size_t s_shift) override;
+
+  // Rows, columns and wrapped regions in one pass
+  bool validateGrid() const override;
+  bool isConsistent() const override;
+
+  // Completes against the wrapped regions: shifted onto plain boxes, completed there and shifted back
+  bool complete() override;
+
+  // The base edit checks the standard box, so consistency is rescanned over the regions
+  void setCell(size_t pos, uint8_t val) override;
+
+  // Band and stack moves act on the bands and stacks of regions, which wrap like the regions do
+  void bandSwap(size_t idx1, size_t idx2) override;
+  void bandRowSwap(size_t band, size_t idx1, size_t idx2) override;
+  void stackSwap(size_t idx1, size_t idx2) override;
+  void stackColSwap(size_t stack, size_t idx1, size_t idx2) override;
+
+  // Whole-grid symmetries carry the offsets along (rotations follow through these); digPermut applies unchanged
+  void reflection(bool type) override;
+  void transpose() override;
+
+  // The base generators on plain boxes, shifted onto the current regions (band_draw follows through band_load)
+  void root_generate(bool type) override;
+  void root_generate(bool type, size_t pos) override;
+  void root_generate(bool type, Box box, size_t pos) override;
+  void band_generate() override;
+  void band_load(uint64_t ref) override;
+  void line_generate() override;
+  void line_generate(std::array<uint8_t*, 9> row, std::array<uint8_t*, 9> col) override;
+
+  // src is a grid on the current regions: shifted onto plain boxes, mapped by sym there and shifted back
+  void gather(const std::array<uint8_t, 81>& src, const Symmetry& sym) override;
+
+private:
+
+  size_t rowShift = 0, colShift = 0;
+  std::array<uint8_t, 81> regionMap;
+
+  void setOffsets(size_t rows, size_t cols);
+  bool scan(bool complete) const;
+
+  // Runs fn on plain boxes (offsets 0), then shifts the grid it wrote back onto the current regions
+  template <class Fn> void onBoxes(Fn fn) {
+    size_t r = rowShift, c = colShift;
+    setOffsets(0, 0);
+    fn();
+    lineShift(9 - r, 9 - c);
+  }
+};
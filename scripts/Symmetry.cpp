@@ -0,0 +1,122 @@
+#include "Symmetry.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+Symmetry Symmetry::random() {// One uniform code is one uniform group element, since decode is a bijection
+	return decode(std::uniform_int_distribution<uint64_t>(0, codes - 1)(threadRng()));
+}
+
+static constexpr std::array<uint8_t, 9> identity = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+
+template <size_t N>
+static uint32_t rank(const uint8_t* perm) {// Lehmer rank of a permutation of 0..N-1, 0 for the identity
+	uint32_t code = 0;
+
+	for (size_t i = 0; i < N; i++) {
+		uint32_t smaller = 0;
+		for (size_t j = i + 1; j < N; j++) smaller += perm[j] < perm[i];
+		code = code * uint32_t(N - i) + smaller;
+	}
+
+	return code;
+}
+
+template <size_t N>
+static void unrank(uint32_t code, uint8_t* perm) {
+	std::array<uint8_t, N> digits, pool;
+	for (size_t i = N; i-- > 0;) { digits[i] = uint8_t(code % (N - i)); code /= uint32_t(N - i); }
+	for (size_t i = 0; i < N; i++) pool[i] = uint8_t(i);
+
+	for (size_t i = 0, left = N; i < N; i++, left--) {
+		perm[i] = pool[digits[i]];
+		std::copy(pool.begin() + digits[i] + 1, pool.begin() + left, pool.begin() + digits[i]);
+	}
+}
+
+static uint32_t lineCode(const std::array<uint8_t, 9>& order) {// Block order, then the order inside each placed block
+	std::array<uint8_t, 3> blocks;
+	uint32_t code = 0;
+
+	for (size_t b = 0; b < 3; b++) {
+		blocks[b] = uint8_t(order[3 * b] / 3);
+
+		std::array<uint8_t, 3> inner;
+		for (size_t i = 0; i < 3; i++) {
+			if (order[3 * b + i] / 3 != blocks[b]) throw std::invalid_argument("Symmetry: line order splits a band or stack");
+			inner[i] = uint8_t(order[3 * b + i] % 3);
+		}
+
+		if (!std::is_permutation(inner.begin(), inner.end(), identity.begin())) throw std::invalid_argument("Symmetry: line order repeats a line");
+		code = code * 6 + rank<3>(inner.data());
+	}
+
+	if (!std::is_permutation(blocks.begin(), blocks.end(), identity.begin())) throw std::invalid_argument("Symmetry: line order repeats a block");
+	return rank<3>(blocks.data()) * 216 + code;
+}
+
+static void lineOrder(uint32_t code, std::array<uint8_t, 9>& order) {
+	std::array<uint8_t, 3> blocks;
+	unrank<3>(code / 216, blocks.data());
+
+	for (size_t b = 3; b-- > 0;) {
+		std::array<uint8_t, 3> inner;
+		unrank<3>(code % 6, inner.data());
+		code /= 6;
+		for (size_t i = 0; i < 3; i++) order[3 * b + i] = uint8_t(3 * blocks[b] + inner[i]);
+	}
+}
+
+std::array<uint8_t, 9> Symmetry::lines(uint32_t code) {
+	std::array<uint8_t, 9> order;
+	lineOrder(code, order);
+	return order;
+}
+
+uint64_t Symmetry::encode() const {
+	std::array<uint8_t, 9> relabel;
+	for (size_t d = 0; d < 9; d++) relabel[d] = uint8_t(digits[d + 1] - 1);
+
+	if (digits[0] || !std::is_permutation(relabel.begin(), relabel.end(), identity.begin())) {
+		throw std::invalid_argument("Symmetry: digits are not a relabeling of 1..9");
+	}
+
+	uint64_t code = lineCode(rows);
+	code = code * 1296 + lineCode(cols);
+	code = code * 2 + transpose;
+	return code * 362880 + rank<9>(relabel.data());
+}
+
+Symmetry Symmetry::decode(uint64_t code) {
+	if (code >= codes) throw std::out_of_range("Symmetry: code out of range");
+
+	Symmetry sym;
+	std::array<uint8_t, 9> relabel;
+
+	uint32_t lines = uint32_t(code / 362880); // one wide division, the rest fits in 32 bits
+	unrank<9>(uint32_t(code - uint64_t(lines) * 362880), relabel.data());
+	for (size_t d = 0; d < 9; d++) sym.digits[d + 1] = uint8_t(relabel[d] + 1);
+
+	sym.transpose = lines % 2;
+	lines /= 2;
+	lineOrder(lines % 1296, sym.cols);
+	lineOrder(lines / 1296, sym.rows);
+
+	return sym;
+}
+
+Symmetry Symmetry::then(const Symmetry& next) const {// next reads this result, so its lines index into ours, swapped when it transposes
+	Symmetry out;
+
+	for (size_t i = 0; i < 9; i++) {
+		out.rows[i] = next.transpose ? cols[next.rows[i]] : rows[next.rows[i]];
+		out.cols[i] = next.transpose ? rows[next.cols[i]] : cols[next.cols[i]];
+	}
+
+	for (size_t d = 0; d < 10; d++) out.digits[d] = next.digits[digits[d]];
+	out.transpose = transpose != next.transpose;
+
+	return out;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// One element of the grid's symmetry group: a band-preserving row permutation, a stack-preserving column
+// permutation, an optional transpose and a digit relabeling. It is applied as a single gather where cell (r, c)
+// of the result is digits[source(rows[r], cols[c])], read as source(cols[c], rows[r]) when transposed.
+struct Symmetry {
+  std::array<uint8_t, 9> rows = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+  std::array<uint8_t, 9> cols = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+  std::array<uint8_t, 10> digits = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }; // blanks always map to blanks
+  bool transpose = false;
+
+  // Size of the code space: 3!^4 row orders, 3!^4 column orders, transpose, 9! relabelings (just under 2^41)
+  static constexpr uint64_t codes = 1296ull * 1296ull * 2ull * 362880ull;
+  static constexpr unsigned codeBits = 41;
+
+  // Uniform over the whole group, from a single draw
+  static Symmetry random();
+
+  // Mixed-radix code, Lehmer-ranked per factor; encode throws std::invalid_argument outside the group
+  uint64_t encode() const;
+  static Symmetry decode(uint64_t code);
+
+  // Band- or stack-preserving line order for a code below 1296: block order, then the order inside each block
+  static std::array<uint8_t, 9> lines(uint32_t code);
+
+  // The single symmetry equal to applying this one and then next
+  Symmetry then(const Symmetry& next) const;
+
+  bool operator==(const Symmetry& other) const {
+    return rows == other.rows && cols == other.cols && digits == other.digits && transpose == other.transpose;
+  }
+};
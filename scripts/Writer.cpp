@@ -0,0 +1,111 @@
+#include "Writer.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <cerrno>
+
+#include <unistd.h>
+
+GridWriter::GridWriter(int fd, size_t workers, Format::Kind format, Overflow overflow, size_t ringCapacity, size_t blockBytes, const Placement& placement)
+	: fd(fd), format(format), overflow(overflow), blockBytes(blockBytes) {
+	lanes.resize(workers);
+	for (size_t w = 0; w < workers; w++) placement.local(w, [&] { lanes[w] = std::make_unique<Lane>(ringCapacity); });
+	drainer = std::thread(&GridWriter::drain, this);
+}
+
+GridWriter::~GridWriter() { close(); }
+
+bool GridWriter::submit(size_t worker, const std::array<uint8_t, 81>& cells) {
+	Lane& lane = *lanes[worker];
+	Enumerator::Packed packed = Enumerator::pack(cells);
+	lane.submitted.fetch_add(1, std::memory_order_relaxed);
+
+	for (bool waited = false; failed() || !lane.ring.push(packed);) {
+		if (overflow == Overflow::Drop || !open.load(std::memory_order_relaxed) || failed()) {
+			lane.dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		if (!waited) { lane.stalls.fetch_add(1, std::memory_order_relaxed); waited = true; }
+		std::this_thread::yield();
+	}
+
+	return true;
+}
+
+bool GridWriter::flush(const char* data, size_t length) {// Only the first error is kept; after it nothing more is written
+	if (failed()) return false;
+
+	size_t sent = 0;
+	while (sent < length) {
+		ssize_t n = ::write(fd, data + sent, length - sent);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) { error.store(n < 0 ? errno : EIO, std::memory_order_relaxed); break; }
+		sent += size_t(n);
+	}
+
+	bytes.fetch_add(sent, std::memory_order_relaxed);
+	writes.fetch_add(1, std::memory_order_relaxed);
+	return sent == length;
+}
+
+void GridWriter::drain() {// Round-robin over the lanes, up to a block per pass, writing once the block fills or the lanes run dry
+	std::vector<char> block;
+	block.resize(blockBytes + Format::maxBytes);
+	size_t used = 0;
+
+	Enumerator::Packed packed;
+	unsigned idle = 0;
+	uint64_t inBlock = 0; // grids in block, counted as written only once their bytes are out
+
+	// A block that fails to go out counts as dropped, as does everything taken after the failure
+	auto send = [&] {
+		if (flush(block.data(), used)) written.fetch_add(inBlock, std::memory_order_relaxed);
+		else lost.fetch_add(inBlock, std::memory_order_relaxed);
+		used = 0; inBlock = 0;
+	};
+
+	for (;;) {
+		bool closing = !open.load(std::memory_order_acquire);
+		uint64_t taken = 0;
+
+		for (auto& lane : lanes) {
+			while (used < blockBytes && lane->ring.pop(packed)) {
+				if (format == Format::Kind::Binary) { std::copy(packed.begin(), packed.end(), block.begin() + used); used += packed.size(); }
+				else used += Format::write(format, Enumerator::unpack(packed), block.data() + used);
+				taken++;
+			}
+		}
+
+		inBlock += taken;
+
+		if (used >= blockBytes) { send(); continue; }
+		if (taken) { idle = 0; continue; }
+
+		// Lanes are dry: push out what we have, then back off; once closed, a dry pass is the last one
+		if (used) send();
+		if (closing) break;
+
+		// Backoff grows to 1 ms so an idle writer doesn't steal a core from slow generators
+		if (++idle < 64) std::this_thread::yield();
+		else std::this_thread::sleep_for(std::chrono::microseconds(std::min<unsigned>(1000, 50u << std::min(idle - 64, 5u))));
+	}
+}
+
+void GridWriter::close() {
+	if (!open.exchange(false)) return;
+	drainer.join();
+}
+
+GridWriter::Stats GridWriter::stats() const {
+	Stats s{ 0, written.load(), lost.load(), 0, bytes.load(), writes.load(), error.load() };
+
+	for (const auto& lane : lanes) {
+		s.submitted += lane->submitted.load();
+		s.dropped += lane->dropped.load();
+		s.stalls += lane->stalls.load();
+	}
+
+	return s;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Queue.h"
+#include "Enumerator.h"
+#include "Format.h"
+#include "Placement.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Output stage for parallel generation. Every worker owns a lock-free ring of packed grids; one writer thread
+// drains all rings into a large buffer and hands it to write() in big blocks, so workers never touch the stream.
+// A full ring either drops the grid or makes the worker wait, and both are counted. The first failed write() ends
+// the output: the writer keeps its errno, discards what is still queued and turns every later submit away.
+class GridWriter {
+
+public:
+
+  enum class Overflow { Block, Drop };
+
+  struct Stats {
+    uint64_t submitted, written, dropped, stalls, bytes, writes;
+    int error; // errno of the failed write(), 0 while every block went out whole
+  };
+
+  // With a pinning placement each worker's ring is allocated from that worker's CPU, so it sits on its node
+  GridWriter(int fd, size_t workers, Format::Kind format = Format::Kind::Line, Overflow overflow = Overflow::Block, size_t ringCapacity = 4096, size_t blockBytes = 1 << 20,
+             const Placement& placement = Placement());
+  ~GridWriter();
+
+  GridWriter(const GridWriter&) = delete;
+  GridWriter& operator=(const GridWriter&) = delete;
+
+  // Called only from worker `worker`; false when the grid was dropped
+  bool submit(size_t worker, const std::array<uint8_t, 81>& cells);
+
+  // True once a write() has failed; submits are refused from then on, so producers should stop
+  bool failed() const { return error.load(std::memory_order_relaxed) != 0; }
+
+  // Once the workers are done submitting: drains every ring, flushes and stops the writer thread
+  void close();
+
+  Stats stats() const;
+
+private:
+
+  // Per-worker producer side, padded so counters of neighbouring workers don't share a line
+  struct alignas(64) Lane {
+    explicit Lane(size_t capacity) : ring(capacity) {}
+
+    SpscRing<Enumerator::Packed> ring;
+    std::atomic<uint64_t> submitted{ 0 }, dropped{ 0 }, stalls{ 0 }; // stalls: submits that found the ring full and waited
+  };
+
+  int fd;
+  Format::Kind format;
+  Overflow overflow;
+  size_t blockBytes;
+
+  std::vector<std::unique_ptr<Lane>> lanes;
+  std::atomic<bool> open{ true };
+  std::atomic<uint64_t> written{ 0 }, lost{ 0 }, bytes{ 0 }, writes{ 0 }; // lost: taken but never written
+  std::atomic<int> error{ 0 };
+  std::thread drainer;
+
+  void drain();
+  bool flush(const char* data, size_t length);
+};